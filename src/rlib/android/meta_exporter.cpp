@@ -0,0 +1,328 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+// Own
+#include "rlib/android/meta_exporter.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Value types of the data file from the narrowest to the widest
+enum class value_type { U8, I8, U16, I16, U32, I32, U64, I64, F32, F64 };
+
+// Range of the values of a sensor, decides the narrowest type storing them
+// exactly
+class value_range {
+    public:
+    double min = std::numeric_limits< double >::infinity();
+    double max = -std::numeric_limits< double >::infinity();
+    bool integral = true;
+    bool fits_f32 = true;
+
+    void add(double value)
+    {
+        if (!std::isfinite(value) || std::trunc(value) != value) {
+            this->integral = false;
+        }
+        if (!std::isnan(value)) {
+            this->min = std::fmin(this->min, value);
+            this->max = std::fmax(this->max, value);
+        }
+        if (!std::isnan(value) && double(float(value)) != value) {
+            this->fits_f32 = false;
+        }
+    }
+
+    value_type type() const
+    {
+        // Integers beyond 2^53 are not exact in a double anyway
+        const double exact = 9007199254740992.0;
+        if (this->integral && this->min >= -exact && this->max <= exact) {
+            if (this->min >= 0) {
+                return this->max <= 255.0
+                           ? value_type::U8
+                           : this->max <= 65535.0
+                                 ? value_type::U16
+                                 : this->max <= 4294967295.0 ? value_type::U32
+                                                             : value_type::U64;
+            }
+            if (this->min >= -128.0 && this->max <= 127.0) {
+                return value_type::I8;
+            }
+            if (this->min >= -32768.0 && this->max <= 32767.0) {
+                return value_type::I16;
+            }
+            if (this->min >= -2147483648.0 && this->max <= 2147483647.0) {
+                return value_type::I32;
+            }
+            return value_type::I64;
+        }
+        return this->fits_f32 ? value_type::F32 : value_type::F64;
+    }
+};
+
+// Name of type in the meta file
+static std::string type_name(value_type type)
+{
+    switch (type) {
+        case value_type::U8:
+            return "u8";
+        case value_type::I8:
+            return "i8";
+        case value_type::U16:
+            return "u16";
+        case value_type::I16:
+            return "i16";
+        case value_type::U32:
+            return "u32";
+        case value_type::I32:
+            return "i32";
+        case value_type::U64:
+            return "u64";
+        case value_type::I64:
+            return "i64";
+        case value_type::F32:
+            return "f32";
+        case value_type::F64:
+            return "f64";
+    }
+    return "f64";
+}
+
+// Size of type in bytes
+static size_t type_size(value_type type)
+{
+    switch (type) {
+        case value_type::U8:
+        case value_type::I8:
+            return sizeof(uint8_t);
+        case value_type::U16:
+        case value_type::I16:
+            return sizeof(uint16_t);
+        case value_type::U32:
+        case value_type::I32:
+        case value_type::F32:
+            return sizeof(uint32_t);
+        case value_type::U64:
+        case value_type::I64:
+        case value_type::F64:
+            return sizeof(uint64_t);
+    }
+    return sizeof(uint64_t);
+}
+
+// Stores value as T at dst
+template < class T >
+static void store(double value, char* dst)
+{
+    T v = T(value);
+    std::memcpy(dst, &v, sizeof(v));
+}
+
+// Stores value as type at dst
+static void encode(value_type type, double value, char* dst)
+{
+    switch (type) {
+        case value_type::U8:
+            store< uint8_t >(value, dst);
+            return;
+        case value_type::I8:
+            store< int8_t >(value, dst);
+            return;
+        case value_type::U16:
+            store< uint16_t >(value, dst);
+            return;
+        case value_type::I16:
+            store< int16_t >(value, dst);
+            return;
+        case value_type::U32:
+            store< uint32_t >(value, dst);
+            return;
+        case value_type::I32:
+            store< int32_t >(value, dst);
+            return;
+        case value_type::U64:
+            store< uint64_t >(value, dst);
+            return;
+        case value_type::I64:
+            store< int64_t >(value, dst);
+            return;
+        case value_type::F32:
+            store< float >(value, dst);
+            return;
+        case value_type::F64:
+            store< double >(value, dst);
+            return;
+    }
+}
+
+rlib::android::meta_exporter::meta_exporter(
+    std::shared_ptr< rlib::common::reader > reader, std::string filename)
+    : rlib::common::exporter(reader)
+    , _filename(filename)
+{
+    if (this->_filename.size() < 4) {
+        throw std::runtime_error("Invalid meta filename " + this->_filename);
+    }
+}
+
+// Export data from begin (in seconds) till end (in seconds) to output stream
+void rlib::android::meta_exporter::data_export(
+    double begin, double end, std::ostream& output)
+{
+    this->data_export(begin, end, -1, output);
+}
+
+// Export data from begin (in seconds) till end (in seconds) to output stream
+// with resolution r
+void rlib::android::meta_exporter::data_export(
+    double begin, double end, int_fast32_t r, std::ostream& output)
+{
+    // Same naming as meta
+    const std::string base =
+        this->_filename.substr(0, this->_filename.size() - 4);
+    auto sensors = this->reader->sensors();
+
+    // The data is passed twice, once to find the narrowest type of every
+    // sensor and once to write the records
+    std::vector< rlib::common::sample > data;
+    if (r > 0) {
+        data = this->reader->samples(begin, end, r);
+    }
+    auto for_each_chunk =
+        [&](const std::function< void(std::vector< rlib::common::sample >&) >&
+                consumer) {
+            if (r > 0) {
+                consumer(data);
+                return;
+            }
+            this->reader->for_each_chunk(begin, end, EXPORT_CHUNK_LENGTH,
+                [&](size_t, std::vector< rlib::common::sample >& chunk) {
+                    consumer(chunk);
+                });
+        };
+
+    const double nan = std::numeric_limits< double >::quiet_NaN();
+    std::vector< value_range > ranges(sensors.size());
+    for_each_chunk([&](std::vector< rlib::common::sample >& chunk) {
+        for (auto& datum : chunk) {
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                ranges[ i ].add(
+                    i < datum.values.size() ? datum.values[ i ] : nan);
+            }
+        }
+    });
+    std::vector< value_type > types;
+    size_t recordSize = sizeof(uint64_t);
+    for (auto& range : ranges) {
+        types.push_back(range.type());
+        recordSize += type_size(types.back());
+    }
+
+    // Records are the time (u64 in ns) followed by the value of every sensor
+    std::ofstream dataStream(base + "data", std::ios::binary);
+    if (!dataStream.good()) {
+        throw std::runtime_error("Can not write " + base + "data");
+    }
+    std::vector< char > buffer;
+    for_each_chunk([&](std::vector< rlib::common::sample >& chunk) {
+        buffer.resize(chunk.size() * recordSize);
+        char* record = buffer.data();
+        for (auto& datum : chunk) {
+            auto time =
+                uint64_t(std::llround(std::fmax(datum.time, 0.0) * 1e9));
+            std::memcpy(record, &time, sizeof(time));
+            char* field = record + sizeof(uint64_t);
+            for (size_t i = 0; i < types.size(); ++i) {
+                encode(types[ i ],
+                    i < datum.values.size() ? datum.values[ i ] : nan, field);
+                field += type_size(types[ i ]);
+            }
+            record += recordSize;
+        }
+        dataStream.write(buffer.data(), std::streamsize(buffer.size()));
+    });
+    dataStream.close();
+
+    // Events are lines of the time in ms and the message
+    std::ofstream eventStream(base + "event", std::ios::binary);
+    eventStream << std::setprecision(17);
+    for (auto& event : this->reader->events(begin, end)) {
+        std::string message = event.message;
+        std::replace(message.begin(), message.end(), '\n', ' ');
+        eventStream << event.time * 1000.0 << ":" << message << "\n";
+    }
+    eventStream.close();
+
+    // Names are keys in the meta and separated by | in the format
+    std::set< std::string > names = { "time" };
+    std::string format = "time";
+    boost::property_tree::ptree meta_xml;
+    {
+        meta_xml.put("grim.<xmlattr>.version", "1.0");
+        meta_xml.put("grim.meta.name", this->reader->filename());
+        meta_xml.put("grim.meta.init", 0);
+        auto& values =
+            meta_xml.put_child("grim.values", boost::property_tree::ptree());
+        boost::property_tree::ptree time;
+        {
+            time.put("<xmlattr>.name", "time");
+            time.put("<xmlattr>.type", "u64");
+            time.put("<xmlattr>.unit", "ns");
+        }
+        values.add_child("value", time);
+        for (size_t i = 0; i < sensors.size(); ++i) {
+            std::string name = sensors[ i ].name;
+            std::replace(name.begin(), name.end(), '|', '_');
+            while (name.empty() || names.count(name) > 0) {
+                name += "_" + std::to_string(i);
+            }
+            names.insert(name);
+            format += "|" + name;
+
+            boost::property_tree::ptree value;
+            {
+                value.put("<xmlattr>.name", name);
+                value.put("<xmlattr>.type", type_name(types[ i ]));
+                value.put("<xmlattr>.unit", sensors[ i ].unit);
+            }
+            values.add_child("value", value);
+        }
+        meta_xml.put("grim.meta.format", format);
+    }
+    boost::property_tree::write_xml(output, meta_xml);
+}
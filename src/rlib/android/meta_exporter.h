@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+#include "rlib/common/exporter.h"
+
+// StdLib
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace rlib::android {
+    // Writes the samples and events of a reader as meta (written to the
+    // output stream), data and event files (next to filename, named like
+    // meta expects them)
+    class meta_exporter : public common::exporter {
+        private:
+        std::string _filename;
+
+        public:
+        // filename is the name of the meta file (e.g. data.meta), the
+        // samples are written to data.data and the events to data.event
+        meta_exporter(
+            std::shared_ptr< common::reader > reader, std::string filename);
+
+        virtual void data_export(double begin, double end,
+            std::ostream& output = std::cout) override final;
+        virtual void data_export(double begin, double end, int_fast32_t r,
+            std::ostream& output = std::cout) override final;
+    };
+}
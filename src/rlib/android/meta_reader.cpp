@@ -23,9 +23,14 @@
 
 // Own
 #include "rlib/android/meta_reader.h"
+#include "rlib/common/decode.h"
+#include "rlib/common/parallel.h"
 
 // StdLib
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -33,6 +38,128 @@
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
+
+// Type of a field from its name in the meta file
+static rlib::android::meta_reader::field_type parse_type(
+    const std::string& type)
+{
+    using field_type = rlib::android::meta_reader::field_type;
+    static const std::map< std::string, field_type > types = {
+        { "i8", field_type::I8 },
+        { "i16", field_type::I16 },
+        { "i32", field_type::I32 },
+        { "i64", field_type::I64 },
+        { "u8", field_type::U8 },
+        { "u16", field_type::U16 },
+        { "u32", field_type::U32 },
+        { "u64", field_type::U64 },
+        { "f32", field_type::F32 },
+        { "f64", field_type::F64 },
+    };
+    auto it = types.find(type);
+    return it == types.end() ? field_type::UNKNOWN : it->second;
+}
+
+// Size of a value of type in bytes (0 if the type is unknown)
+static size_t type_size(rlib::android::meta_reader::field_type type)
+{
+    using field_type = rlib::android::meta_reader::field_type;
+    switch (type) {
+        case field_type::I8:
+        case field_type::U8:
+            return sizeof(uint8_t);
+        case field_type::I16:
+        case field_type::U16:
+            return sizeof(uint16_t);
+        case field_type::I32:
+        case field_type::U32:
+        case field_type::F32:
+            return sizeof(uint32_t);
+        case field_type::I64:
+        case field_type::U64:
+        case field_type::F64:
+            return sizeof(uint64_t);
+        case field_type::UNKNOWN:
+            return 0;
+    }
+    return 0;
+}
+
+// Decodes count values of type which are stride bytes apart at src into dst
+// (dst_stride doubles apart), every type has its own instance of the kernel
+static void decode_column(rlib::android::meta_reader::field_type type,
+    const char* src, size_t count, size_t stride, double* dst,
+    size_t dst_stride)
+{
+    using field_type = rlib::android::meta_reader::field_type;
+    switch (type) {
+        case field_type::I8:
+            rlib::common::decode_strided< int8_t >(
+                src, count, stride, dst, dst_stride);
+            return;
+        case field_type::I16:
+            rlib::common::decode_strided< int16_t >(
+                src, count, stride, dst, dst_stride);
+            return;
+        case field_type::I32:
+            rlib::common::decode_strided< int32_t >(
+                src, count, stride, dst, dst_stride);
+            return;
+        case field_type::I64:
+            rlib::common::decode_strided< int64_t >(
+                src, count, stride, dst, dst_stride);
+            return;
+        case field_type::U8:
+            rlib::common::decode_strided< uint8_t >(
+                src, count, stride, dst, dst_stride);
+            return;
+        case field_type::U16:
+            rlib::common::decode_strided< uint16_t >(
+                src, count, stride, dst, dst_stride);
+            return;
+        case field_type::U32:
+            rlib::common::decode_strided< uint32_t >(
+                src, count, stride, dst, dst_stride);
+            return;
+        case field_type::U64:
+            rlib::common::decode_strided< uint64_t >(
+                src, count, stride, dst, dst_stride);
+            return;
+        case field_type::F32:
+            rlib::common::decode_strided< float >(
+                src, count, stride, dst, dst_stride);
+            return;
+        case field_type::F64:
+            rlib::common::decode_strided< double >(
+                src, count, stride, dst, dst_stride);
+            return;
+        case field_type::UNKNOWN:
+            break;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        dst[ i * dst_stride ] = std::nan("");
+    }
+}
+
+// Divisor converting a raw time value with unit into seconds (0 if the unit
+// is unknown)
+static double time_divisor(const std::string& unit)
+{
+    if (unit == "ns") {
+        return 1000.0 * 1000.0 * 1000.0;
+    }
+    if (unit == "µs") {
+        return 1000.0 * 1000.0;
+    }
+    if (unit == "ms") {
+        return 1000.0;
+    }
+    if (unit == "s") {
+        return 1.0;
+    }
+    return 0.0;
+}
 
 void rlib::android::meta_reader::preload_events()
 {
@@ -52,24 +179,52 @@ void rlib::android::meta_reader::preload_events()
         }
         std::string text = event_format_stream.str();
 
-        rlib::common::event_data event;
-        {
-            event.time = time;
-            event.origin = -1;
-            event.message = text;
-            event.event_level = rlib::common::event_data_level::VERBOS;
-        }
-        this->_events.push_back(event);
+        this->_events.add(time, rlib::common::event_data_level::VERBOS, -1,
+            text, nullptr, 0);
     }
+    this->_events.sort_by_time();
     return;
 }
 
 rlib::android::meta_reader::meta_reader(std::string filename)
 {
     this->_meta = std::make_unique< meta >(filename);
+    this->_data = std::make_unique< rlib::common::mapped_file >(
+        this->_meta->data_filename,
+        rlib::common::mapped_file::access::SEQUENTIAL);
+    this->compile_layout();
     this->preload_events();
 }
 
+void rlib::android::meta_reader::compile_layout()
+{
+    record_layout layout;
+    {
+        layout.has_time = false;
+        layout.time_offset = 0;
+        layout.time_divisor = 0.0;
+        layout.stride = 0;
+    }
+    for (auto& name : this->_meta->format) {
+        if (name == "time") {
+            // The time is always an u64
+            layout.has_time = true;
+            layout.time_offset = layout.stride;
+            layout.time_divisor = time_divisor(this->_meta->unit[ name ]);
+            layout.stride += sizeof(uint64_t);
+            continue;
+        }
+        field f;
+        {
+            f.type = parse_type(this->_meta->type[ name ]);
+            f.offset = layout.stride;
+        }
+        layout.fields.push_back(f);
+        layout.stride += type_size(f.type);
+    }
+    this->_layout = std::move(layout);
+}
+
 std::string rlib::android::meta_reader::filename()
 {
     return this->_meta->meta_filename;
@@ -105,107 +260,57 @@ std::vector< rlib::common::sample > rlib::android::meta_reader::samples(
     }
     end = fmin(this->length(), end);
 
-    std::ifstream data_stream(this->_meta->data_filename, std::ios::binary);
-    while (data_stream.good()) {
-        rlib::common::sample datum;
-        for (auto name : this->_meta->format) {
-            if (name == "time") {
-                uint64_t raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                if (this->_meta->unit[ name ] == "ns") {
-                    datum.time = double(raw_value) / (1000.0 * 1000.0 * 1000.0);
-                }
-                if (this->_meta->unit[ name ] == "µs") {
-                    datum.time = double(raw_value) / (1000.0 * 1000.0);
-                }
-                if (this->_meta->unit[ name ] == "ms") {
-                    datum.time = double(raw_value) / (1000.0);
-                }
-                if (this->_meta->unit[ name ] == "s") {
-                    datum.time = double(raw_value);
-                }
-                continue;
-            }
-            std::string type = this->_meta->type[ name ];
-            double value;
-            if (type == "i8") {
-                int8_t raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                value = double(raw_value);
-            }
-            if (type == "i16") {
-                int16_t raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                value = double(raw_value);
+    // Timestamps are monotonic, so the records from begin till end are found
+    // by bisection and decoded in parallel slices of blocks
+    const size_t first = this->first_record(begin);
+    const size_t last = std::max(first, this->end_record(end));
+    data_vector.resize(last - first);
+    rlib::common::for_each_slice(last - first, DECODE_BLOCK_RECORDS,
+        [&](size_t slice_first, size_t count) {
+            for (size_t i = 0; i < count; i += DECODE_BLOCK_RECORDS) {
+                this->decode_block(first + slice_first + i,
+                    std::min(DECODE_BLOCK_RECORDS, count - i),
+                    data_vector.data() + slice_first + i);
             }
-            if (type == "i32") {
-                int32_t raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                value = double(raw_value);
-            }
-            if (type == "i64") {
-                int64_t raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                value = double(raw_value);
-            }
-            if (type == "u8") {
-                uint8_t raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                value = double(raw_value);
-            }
-            if (type == "u16") {
-                uint16_t raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                value = double(raw_value);
-            }
-            if (type == "u32") {
-                uint32_t raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                value = double(raw_value);
-            }
-            if (type == "u64") {
-                uint64_t raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                value = double(raw_value);
-            }
-            if (type == "f32") {
-                float raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                value = double(raw_value);
-            }
-            if (type == "f64") {
-                double raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                value = double(raw_value);
-            }
-            datum.values.push_back(value);
-        }
-        if (datum.time > end) {
-            break;
-        }
-        if (begin <= datum.time && datum.time <= end) {
-            data_vector.push_back(datum);
+        });
+    return data_vector;
+}
+
+void rlib::android::meta_reader::decode_block(
+    size_t first, size_t count, rlib::common::sample* data)
+{
+    // Records are decoded one column (field) after another following the
+    // compiled layout
+    const auto& layout = this->_layout;
+    const char* block = this->_data->data() + first * layout.stride;
+    const size_t sensors = layout.fields.size();
+    std::vector< double > times(count, 0.0);
+    std::vector< double > values(count * sensors);
+    if (layout.has_time && layout.time_divisor > 0.0) {
+        rlib::common::decode_strided< uint64_t >(
+            block + layout.time_offset, count, layout.stride, times.data());
+        for (size_t i = 0; i < count; ++i) {
+            times[ i ] /= layout.time_divisor;
         }
     }
+    for (size_t sensor = 0; sensor < sensors; ++sensor) {
+        const auto& f = layout.fields[ sensor ];
+        decode_column(f.type, block + f.offset, count, layout.stride,
+            values.data() + sensor, sensors);
+    }
 
-    return data_vector;
+    for (size_t i = 0; i < count; ++i) {
+        auto& datum = data[ i ];
+        datum.time = times[ i ];
+        auto record_values = values.begin() + std::ptrdiff_t(i * sensors);
+        datum.values.assign(
+            record_values, record_values + std::ptrdiff_t(sensors));
+    }
 }
 
 std::vector< rlib::common::event_data > rlib::android::meta_reader::events(
     double begin, double end)
 {
-    std::vector< rlib::common::event_data > eventVector;
     if (begin < 0) {
         begin = 0;
     }
@@ -213,53 +318,89 @@ std::vector< rlib::common::event_data > rlib::android::meta_reader::events(
         end = this->length();
     }
     end = std::fmin(this->length(), end);
-    for (auto& event : this->_events) {
-        if (event.time > begin && event.time < end) {
-            eventVector.push_back(event);
-        }
+    return this->_events.events(begin, end);
+}
+
+std::vector< rlib::common::event_data > rlib::android::meta_reader::
+    events_of_origin(double begin, double end, int64_t origin)
+{
+    if (end < 0) {
+        end = this->length();
     }
-    return eventVector;
+    return this->_events.events_of_origin(
+        std::fmax(begin, 0.0), std::fmin(this->length(), end), origin);
 }
 
-double rlib::android::meta_reader::length()
+std::vector< rlib::common::event_data > rlib::android::meta_reader::
+    events_of_level(
+        double begin, double end, rlib::common::event_data_level level)
 {
-    std::ifstream data_stream(this->_meta->data_filename, std::ios::binary);
-    double length = 0.0;
-    while (data_stream.good() && !data_stream.eof()) {
-        for (auto name : this->_meta->format) {
-            if (name == "time") {
-                uint64_t raw_value;
-                data_stream.read(
-                    reinterpret_cast< char* >(&raw_value), sizeof(raw_value));
-                if (this->_meta->unit[ name ] == "ns") {
-                    length = double(raw_value) / double(1000 * 1000 * 1000);
-                }
-                else if (this->_meta->unit[ name ] == "µs") {
-                    length = double(raw_value) / double(1000 * 1000);
-                }
-                else if (this->_meta->unit[ name ] == "ms") {
-                    length = double(raw_value) / double(1000);
-                }
-                else if (this->_meta->unit[ name ] == "s") {
-                    length = double(raw_value);
-                }
-                continue;
-            }
-            std::string type = this->_meta->type[ name ];
+    if (end < 0) {
+        end = this->length();
+    }
+    return this->_events.events_of_level(
+        std::fmax(begin, 0.0), std::fmin(this->length(), end), level);
+}
 
-            if (type == "i8" || type == "u8") {
-                data_stream.ignore(sizeof(uint8_t));
-            }
-            else if (type == "i16" || type == "u16") {
-                data_stream.ignore(sizeof(uint16_t));
-            }
-            else if (type == "i32" || type == "u32" || type == "f32") {
-                data_stream.ignore(sizeof(uint32_t));
-            }
-            else if (type == "i64" || type == "u64" || type == "f64") {
-                data_stream.ignore(sizeof(uint64_t));
-            }
+size_t rlib::android::meta_reader::records()
+{
+    if (this->_layout.stride == 0) {
+        return 0;
+    }
+    return this->_data->size() / this->_layout.stride;
+}
+
+double rlib::android::meta_reader::record_time(size_t record)
+{
+    const auto& layout = this->_layout;
+    if (!layout.has_time || !(layout.time_divisor > 0.0)) {
+        return 0.0;
+    }
+    return double(this->_data->read< uint64_t >(
+               record * layout.stride + layout.time_offset)) /
+           layout.time_divisor;
+}
+
+size_t rlib::android::meta_reader::first_record(double time)
+{
+    // Timestamps are monotonic so the first record at or after time is found
+    // by bisection
+    size_t low = 0;
+    size_t high = this->records();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (this->record_time(middle) < time) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
         }
     }
-    return length;
+    return low;
+}
+
+size_t rlib::android::meta_reader::end_record(double time)
+{
+    size_t low = 0;
+    size_t high = this->records();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (this->record_time(middle) <= time) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+double rlib::android::meta_reader::length()
+{
+    // Records have a fixed size, the last one holds the length
+    const size_t records = this->records();
+    if (records == 0) {
+        return 0.0;
+    }
+    return this->record_time(records - 1);
 }
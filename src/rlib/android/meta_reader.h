@@ -26,6 +26,8 @@
 // Own
 #include "rlib/android/meta.h"
 #include "rlib/common/event_data.h"
+#include "rlib/common/event_store.h"
+#include "rlib/common/mapped_file.h"
 #include "rlib/common/reader.h"
 #include "rlib/common/sample.h"
 #include "rlib/common/sensor.h"
@@ -38,12 +40,65 @@
 
 namespace rlib::android {
     class meta_reader : public common::reader {
+        public:
+        enum class field_type {
+            I8,
+            I16,
+            I32,
+            I64,
+            U8,
+            U16,
+            U32,
+            U64,
+            F32,
+            F64,
+            UNKNOWN
+        };
+
         private:
+        // Number of records decoded at once, also the smallest slice decoded
+        // by a core
+        constexpr static size_t DECODE_BLOCK_RECORDS = 4096;
+
+        class field {
+            public:
+            field_type type;
+            // Offset within a record in bytes
+            size_t offset;
+        };
+        // Layout of the records of the data file, compiled once from the
+        // format of the meta file so decoding needs no string work
+        class record_layout {
+            public:
+            // Value fields in sensor order
+            std::vector< field > fields;
+            bool has_time;
+            size_t time_offset;
+            // Converts the raw time into seconds (0 if the unit is unknown)
+            double time_divisor;
+            // Size of one record in bytes
+            size_t stride;
+        };
+
         std::unique_ptr< meta > _meta;
-        std::vector< rlib::common::event_data > _events;
+        std::unique_ptr< common::mapped_file > _data;
+        record_layout _layout;
+        common::event_store _events;
 
         private:
+        void compile_layout();
         void preload_events();
+        // Number of complete records of the data file
+        size_t records();
+        // Time (in seconds) of record
+        double record_time(size_t record);
+        // Index of the first record at or after time (in seconds)
+        size_t first_record(double time);
+        // Index of the first record after time (in seconds)
+        size_t end_record(double time);
+        // Decodes count records from record first into data[0..count)
+        void decode_block(
+            size_t first, size_t count, rlib::common::sample* data);
 
         public:
         meta_reader(std::string filename);
@@ -58,6 +113,11 @@ namespace rlib::android {
         // Read Events from begin (in seconds) till end (in seconds)
         virtual std::vector< rlib::common::event_data > events(
             double begin, double end) override final;
+        virtual std::vector< rlib::common::event_data > events_of_origin(
+            double begin, double end, int64_t origin) override final;
+        virtual std::vector< rlib::common::event_data > events_of_level(
+            double begin, double end,
+            rlib::common::event_data_level level) override final;
         virtual double length() override final;
     };
 }
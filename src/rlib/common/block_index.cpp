@@ -0,0 +1,404 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Own
+#include "rlib/common/block_index.h"
+#include "rlib/common/histogram.h"
+#include "rlib/common/integral.h"
+#include "rlib/common/parallel.h"
+#include "rlib/common/quantile_sketch.h"
+#include "rlib/common/segment_tree.h"
+#include "rlib/common/summary.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <experimental/optional>
+#include <utility>
+#include <vector>
+
+// Value of a sensor (NaN if the sample has no value for it)
+static double value(const rlib::common::sample& datum, size_t sensor)
+{
+    if (sensor < datum.values.size()) {
+        return datum.values[ sensor ];
+    }
+    return std::nan("");
+}
+
+// Summary of every sensor over the given samples
+static std::vector< rlib::common::summary > summarize(
+    const std::vector< rlib::common::sample >& data, size_t sensors)
+{
+    std::vector< rlib::common::summary > r(sensors);
+    std::vector< double > column(data.size());
+    for (size_t sensor = 0; sensor < sensors; ++sensor) {
+        size_t count = 0;
+        for (auto& datum : data) {
+            if (sensor < datum.values.size()) {
+                column[ count++ ] = datum.values[ sensor ];
+            }
+        }
+        r[ sensor ].add(column.data(), count);
+    }
+    return r;
+}
+
+// Quantile sketch of every sensor over the given samples
+static std::vector< rlib::common::quantile_sketch > sketch(
+    const std::vector< rlib::common::sample >& data, size_t sensors)
+{
+    std::vector< rlib::common::quantile_sketch > r(sensors);
+    for (auto& datum : data) {
+        size_t count = std::min(sensors, datum.values.size());
+        for (size_t sensor = 0; sensor < count; ++sensor) {
+            r[ sensor ].add(datum.values[ sensor ]);
+        }
+    }
+    return r;
+}
+
+rlib::common::block_index::block_index(
+    std::shared_ptr< reader > reader, double block_length)
+{
+    this->_reader = reader;
+    this->_block_length = block_length;
+    this->_length = reader->length();
+
+    const size_t sensors = reader->sensors().size();
+    std::vector< rlib::common::integrand > integrands;
+    for (size_t sensor = 0; sensor < sensors; ++sensor) {
+        integrands.push_back([sensor](const rlib::common::sample& datum) {
+            return value(datum, sensor);
+        });
+    }
+    rlib::common::block_integrator integrator(integrands, block_length);
+
+    class block {
+        public:
+        std::vector< rlib::common::summary > summaries;
+        std::vector< rlib::common::quantile_sketch > sketches;
+        rlib::common::block_integrator::chunk integrals;
+    };
+    std::vector< block > blocks;
+    rlib::common::map_reduce_chunks(*reader, 0.0, this->_length,
+        this->_block_length, blocks,
+        [sensors, &integrator](
+            size_t chunk, const std::vector< rlib::common::sample >& data) {
+            block b;
+            {
+                b.summaries = summarize(data, sensors);
+                b.sketches = sketch(data, sensors);
+                b.integrals = integrator.integrate(chunk, data);
+            }
+            return b;
+        },
+        [&integrator](std::vector< block >& result, block b) {
+            integrator.append(b.integrals);
+            result.push_back(std::move(b));
+        });
+
+    this->_blocks = size_t(std::floor(this->_length / block_length)) + 1;
+    this->_integrals = integrator.prefix_sums(this->_blocks);
+    block empty;
+    {
+        empty.summaries.resize(sensors);
+        empty.sketches.resize(sensors);
+    }
+    blocks.resize(this->_blocks, empty);
+    for (size_t sensor = 0; sensor < sensors; ++sensor) {
+        std::vector< rlib::common::summary > summaries;
+        std::vector< rlib::common::quantile_sketch > sketches;
+        for (auto& b : blocks) {
+            summaries.push_back(b.summaries[ sensor ]);
+            sketches.push_back(std::move(b.sketches[ sensor ]));
+        }
+        this->_summaries.emplace_back(std::move(summaries));
+        this->_sketches.emplace_back(std::move(sketches));
+    }
+}
+
+std::vector< rlib::common::sample > rlib::common::block_index::scan(
+    double begin, double end, bool closed)
+{
+    auto data = this->_reader->samples(begin, end);
+    data.erase(std::remove_if(data.begin(), data.end(),
+                   [&](const rlib::common::sample& datum) {
+                       return datum.time < begin || datum.time > end ||
+                              (!closed && !(datum.time < end));
+                   }),
+        data.end());
+    return data;
+}
+
+double rlib::common::block_index::block_length() const
+{
+    return this->_block_length;
+}
+
+size_t rlib::common::block_index::blocks() const
+{
+    return this->_blocks;
+}
+
+std::vector< rlib::common::summary > rlib::common::block_index::summaries()
+{
+    std::vector< rlib::common::summary > r;
+    for (auto& tree : this->_summaries) {
+        r.push_back(tree.query(0, this->_blocks));
+    }
+    return r;
+}
+
+rlib::common::block_index::range rlib::common::block_index::split(
+    double begin, double end, size_t group)
+{
+    begin = std::fmax(begin, 0.0);
+    if (end < 0.0 || end > this->_length) {
+        end = this->_length;
+    }
+    range r;
+    {
+        r.first = 0;
+        r.last = 0;
+    }
+    if (begin > end) {
+        return r;
+    }
+
+    // The last block is closed at the end of the data
+    const double length = this->_block_length * double(group);
+    const size_t blocks = (this->_blocks + group - 1) / group;
+    size_t first = size_t(std::ceil(begin / length));
+    size_t last = size_t(std::floor(end / length));
+    if (!(end < this->_length)) {
+        last = blocks;
+    }
+    if (first >= last) {
+        r.edges = this->scan(begin, end, true);
+        return r;
+    }
+    r.first = first;
+    r.last = last;
+    r.edges = this->scan(begin, double(first) * length, false);
+    if (last < blocks) {
+        auto edge = this->scan(double(last) * length, end, true);
+        r.edges.insert(r.edges.end(), edge.begin(), edge.end());
+    }
+    return r;
+}
+
+std::vector< rlib::common::summary > rlib::common::block_index::summaries(
+    double begin, double end)
+{
+    auto range = this->split(begin, end);
+    auto r = summarize(range.edges, this->_summaries.size());
+    for (size_t sensor = 0; sensor < r.size(); ++sensor) {
+        r[ sensor ].merge(
+            this->_summaries[ sensor ].query(range.first, range.last));
+    }
+    return r;
+}
+
+std::vector< rlib::common::quantile_sketch > rlib::common::block_index::
+    sketches(double begin, double end)
+{
+    auto range = this->split(begin, end);
+    auto r = sketch(range.edges, this->_sketches.size());
+    for (size_t sensor = 0; sensor < r.size(); ++sensor) {
+        r[ sensor ].merge(
+            this->_sketches[ sensor ].query(range.first, range.last));
+    }
+    return r;
+}
+
+double rlib::common::block_index::integral(const std::vector< double >& prefix,
+    const rlib::common::integrand& f, double time)
+{
+    size_t block = std::min(
+        this->_blocks, size_t(std::floor(time / this->_block_length)));
+    double begin = double(block) * this->_block_length;
+    double r = prefix[ block ];
+    if (begin < time) {
+        auto data = rlib::common::bracket(
+            *this->_reader, begin, time, this->_block_length);
+        r += rlib::common::integrate(data, f, begin, time).value();
+    }
+    return r;
+}
+
+std::experimental::optional< double > rlib::common::block_index::integral(
+    const std::vector< double >& prefix, const rlib::common::integrand& f,
+    double begin, double end)
+{
+    begin = std::fmax(begin, 0.0);
+    if (end < 0.0 || end > this->_length) {
+        end = this->_length;
+    }
+    if (begin > end) {
+        return {};
+    }
+
+    // Short ranges are integrated directly
+    if (std::floor(begin / this->_block_length) ==
+        std::floor(end / this->_block_length)) {
+        auto data = rlib::common::bracket(
+            *this->_reader, begin, end, this->_block_length);
+        return rlib::common::integrate(data, f, begin, end).value();
+    }
+    return this->integral(prefix, f, end) - this->integral(prefix, f, begin);
+}
+
+std::experimental::optional< double > rlib::common::block_index::integral(
+    size_t sensor, double begin, double end)
+{
+    if (sensor >= this->_integrals.size()) {
+        return {};
+    }
+    return this->integral(this->_integrals[ sensor ],
+        [sensor](const rlib::common::sample& datum) {
+            return value(datum, sensor);
+        },
+        begin, end);
+}
+
+std::experimental::optional< double > rlib::common::block_index::energy(
+    size_t current_sensor, size_t voltage_sensor, double begin, double end)
+{
+    if (current_sensor >= this->_integrals.size() ||
+        voltage_sensor >= this->_integrals.size()) {
+        return {};
+    }
+    rlib::common::integrand power =
+        [current_sensor, voltage_sensor](const rlib::common::sample& datum) {
+            return value(datum, current_sensor) * value(datum, voltage_sensor);
+        };
+
+    auto key = std::make_pair(current_sensor, voltage_sensor);
+    auto it = this->_energies.find(key);
+    if (it == this->_energies.end()) {
+        rlib::common::block_integrator integrator({ power },
+            this->_block_length);
+        std::vector< rlib::common::block_integrator::chunk > chunks;
+        rlib::common::map_reduce_chunks(*this->_reader, 0.0, this->_length,
+            this->_block_length, chunks,
+            [&integrator](size_t chunk,
+                const std::vector< rlib::common::sample >& data) {
+                return integrator.integrate(chunk, data);
+            },
+            [&integrator](
+                std::vector< rlib::common::block_integrator::chunk >&,
+                rlib::common::block_integrator::chunk c) {
+                integrator.append(c);
+            });
+        it = this->_energies
+                 .emplace(key, integrator.prefix_sums(this->_blocks).front())
+                 .first;
+    }
+    return this->integral(it->second, power, begin, end);
+}
+
+void rlib::common::block_index::index_histograms(
+    const std::vector< rlib::common::histogram >& layouts)
+{
+    std::vector< rlib::common::histogram > fine;
+    for (auto& layout : layouts) {
+        fine.emplace_back(layout.min, layout.max,
+            layout.bins() == 0 ? 0 : HISTOGRAM_BINS);
+    }
+
+    this->_histogram_blocks =
+        (this->_blocks + HISTOGRAM_LEAVES - 1) / HISTOGRAM_LEAVES;
+    std::vector< std::vector< rlib::common::histogram > > blocks;
+    rlib::common::map_reduce_chunks(*this->_reader, 0.0, this->_length,
+        this->_block_length * double(this->_histogram_blocks), blocks,
+        [&fine](size_t, const std::vector< rlib::common::sample >& data) {
+            auto r = fine;
+            for (auto& datum : data) {
+                size_t count = std::min(r.size(), datum.values.size());
+                for (size_t sensor = 0; sensor < count; ++sensor) {
+                    r[ sensor ].add(datum.values[ sensor ]);
+                }
+            }
+            return r;
+        },
+        [](std::vector< std::vector< rlib::common::histogram > >& result,
+            std::vector< rlib::common::histogram > b) {
+            result.push_back(std::move(b));
+        });
+    blocks.resize(
+        (this->_blocks + this->_histogram_blocks - 1) / this->_histogram_blocks,
+        fine);
+
+    this->_histograms.clear();
+    for (size_t sensor = 0; sensor < fine.size(); ++sensor) {
+        std::vector< rlib::common::histogram > histograms;
+        for (auto& b : blocks) {
+            histograms.push_back(std::move(b[ sensor ]));
+        }
+        this->_histograms.emplace_back(std::move(histograms));
+    }
+}
+
+bool rlib::common::block_index::has_histograms() const
+{
+    return !this->_histograms.empty();
+}
+
+std::experimental::optional< rlib::common::histogram > rlib::common::
+    block_index::histogram(size_t sensor, double begin, double end, size_t bins)
+{
+    if (sensor >= this->_histograms.size() || bins == 0) {
+        return {};
+    }
+    auto& tree = this->_histograms[ sensor ];
+    auto layout = tree.query(0, tree.size());
+    if (layout.bins() == 0) {
+        return {};
+    }
+
+    if (HISTOGRAM_BINS % bins == 0) {
+        auto range = this->split(begin, end, this->_histogram_blocks);
+        rlib::common::histogram r(layout.min, layout.max, HISTOGRAM_BINS);
+        for (auto& datum : range.edges) {
+            if (sensor < datum.values.size()) {
+                r.add(datum.values[ sensor ]);
+            }
+        }
+        r.merge(tree.query(range.first, range.last));
+        return r.coarsen(bins);
+    }
+
+    // The bins do not line up with the block histograms
+    rlib::common::histogram r(layout.min, layout.max, bins);
+    this->_reader->for_each_chunk(begin, end, this->_block_length,
+        [&](size_t, std::vector< rlib::common::sample >& data) {
+            for (auto& datum : data) {
+                if (sensor < datum.values.size()) {
+                    r.add(datum.values[ sensor ]);
+                }
+            }
+        });
+    return r;
+}
@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+#include "rlib/common/histogram.h"
+#include "rlib/common/integral.h"
+#include "rlib/common/quantile_sketch.h"
+#include "rlib/common/reader.h"
+#include "rlib/common/segment_tree.h"
+#include "rlib/common/summary.h"
+
+// StdLib
+#include <cstddef>
+#include <experimental/optional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace rlib {
+    namespace common {
+        // Per block summary, quantile sketch, integral and histogram of every
+        // sensor of a reader.
+        // Blocks have a fixed length in seconds (block k contains the samples
+        // from k * length till (k + 1) * length) and are arranged as segment
+        // trees, so a range is answered by O(log n) block lookups and a scan
+        // of the two partial blocks at its edges. Integrals are kept as
+        // prefix sums over the blocks, so only the edges need to be read.
+        class block_index {
+            private:
+            // Number of bins of the block histograms. Histograms with any
+            // number of bins dividing it (e.g. 10, 16, 20, 25, 50, 80, 100)
+            // are merged from the block histograms, other numbers of bins
+            // need a scan of the range.
+            constexpr static size_t HISTOGRAM_BINS = 400;
+            // Max. number of leaves of a histogram tree. Longer recordings
+            // combine neighbouring blocks into one leaf, so the histograms of
+            // a sensor never take more than 2 * HISTOGRAM_LEAVES *
+            // HISTOGRAM_BINS counts (6.5 MB).
+            constexpr static size_t HISTOGRAM_LEAVES = 1024;
+
+            std::shared_ptr< reader > _reader;
+            double _block_length;
+            double _length;
+            size_t _blocks;
+            // One segment tree per sensor
+            std::vector< segment_tree< summary > > _summaries;
+            std::vector< segment_tree< quantile_sketch > > _sketches;
+            // Per sensor the prefix sums of the block integrals
+            std::vector< std::vector< double > > _integrals;
+            // Prefix sums of the block integrals of current * voltage per
+            // pair of sensors (built on first use)
+            std::map< std::pair< size_t, size_t >, std::vector< double > >
+                _energies;
+            // One segment tree per sensor (built on demand, see
+            // index_histograms), every leaf covers _histogram_blocks blocks
+            std::vector< segment_tree< common::histogram > > _histograms;
+            size_t _histogram_blocks = 1;
+
+            private:
+            class range {
+                public:
+                // Blocks (or groups of blocks) [first, last) are completely
+                // within the range
+                size_t first;
+                size_t last;
+                // Samples of the range which are not within these blocks
+                std::vector< common::sample > edges;
+            };
+            // Splits the range into the groups of group blocks it covers
+            // completely and the samples at its edges
+            range split(double begin, double end, size_t group = 1);
+            // Integral of f from 0 till time (in seconds) based on the prefix
+            // sums of its block integrals
+            double integral(const std::vector< double >& prefix,
+                const integrand& f, double time);
+            // Integral of f from begin (in seconds) till end (in seconds)
+            std::experimental::optional< double > integral(
+                const std::vector< double >& prefix, const integrand& f,
+                double begin, double end);
+            // Scans the samples from begin (in seconds) till end (in
+            // seconds) of the reader, end is excluded unless closed is set
+            std::vector< common::sample > scan(
+                double begin, double end, bool closed);
+
+            public:
+            // Builds the index in one pass over the samples of reader
+            block_index(std::shared_ptr< reader > reader, double block_length);
+
+            double block_length() const;
+            size_t blocks() const;
+
+            // Summary of every sensor over all samples
+            std::vector< summary > summaries();
+            // Summary of every sensor over the samples from begin (in
+            // seconds) till end (in seconds)
+            std::vector< summary > summaries(double begin, double end);
+            // Quantile sketch of every sensor over the samples from begin (in
+            // seconds) till end (in seconds)
+            std::vector< quantile_sketch > sketches(double begin, double end);
+            // Integral of sensor over time from begin (in seconds) till end
+            // (in seconds), the samples are linearly interpolated
+            std::experimental::optional< double > integral(
+                size_t sensor, double begin, double end);
+            // Integral of current * voltage over time from begin (in
+            // seconds) till end (in seconds)
+            std::experimental::optional< double > energy(size_t current_sensor,
+                size_t voltage_sensor, double begin, double end);
+            // Builds the block histograms in one pass over the samples, the
+            // bins of every sensor span min till max of its layout
+            void index_histograms(
+                const std::vector< common::histogram >& layouts);
+            bool has_histograms() const;
+            // Histogram with bins bins of sensor over the samples from begin
+            // (in seconds) till end (in seconds), requires index_histograms
+            std::experimental::optional< common::histogram > histogram(
+                size_t sensor, double begin, double end, size_t bins);
+        };
+    }
+}
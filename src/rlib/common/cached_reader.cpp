@@ -177,8 +177,7 @@ std::vector< rlib::common::event_data > rlib::common::cached_reader::events(
     int start_chunk = int(std::fmax(0.0, std::floor(begin / EVENT_CHUNK_SIZE)));
     int end_chunk = int(std::ceil(end / EVENT_CHUNK_SIZE));
 
-    std::vector< std::future<
-        std::tuple< int, std::vector< rlib::common::event_data > > > >
+    std::vector< std::future< std::tuple< int, rlib::common::event_store > > >
         futures;
     // Load the chunks parallel (if needed)
     for (int chunk = start_chunk; chunk < end_chunk; ++chunk) {
@@ -187,8 +186,13 @@ std::vector< rlib::common::event_data > rlib::common::cached_reader::events(
                 double chunk_begin = double(chunk) * EVENT_CHUNK_SIZE;
                 double chunk_end = double(chunk + 1) * EVENT_CHUNK_SIZE;
                 // Load Data from Reader
-                return std::make_tuple(
-                    chunk, this->_reader->events(chunk_begin, chunk_end));
+                rlib::common::event_store events;
+                for (auto& event :
+                    this->_reader->events(chunk_begin, chunk_end)) {
+                    events.add(event);
+                }
+                events.sort_by_time();
+                return std::make_tuple(chunk, std::move(events));
             }));
         }
     }
@@ -198,20 +202,29 @@ std::vector< rlib::common::event_data > rlib::common::cached_reader::events(
             0) {
             this->_chunked_event_cache.insert_or_assign(
                 std::get< int >(return_tuple),
-                std::get< std::vector< rlib::common::event_data > >(
-                    return_tuple));
+                std::move(
+                    std::get< rlib::common::event_store >(return_tuple)));
         }
     }
+    // Chunks overlap at their borders if the reader includes the end of a
+    // range (others do not), so events on a border are skipped as often as
+    // the previous chunk emitted them
+    size_t border_events = 0;
     for (int chunk = start_chunk; chunk < end_chunk; ++chunk) {
-        auto events = this->_chunked_event_cache.at(chunk);
-        double last_time = -1.0;
-        if (!event_vector.empty()) {
-            last_time = event_vector.at(event_vector.size() - 1).time;
-        }
-        for (auto& event : events) {
-            if (last_time < event.time && event.time >= begin &&
-                event.time <= end) {
-                event_vector.push_back(event);
+        const auto& events = this->_chunked_event_cache.at(chunk);
+        double chunk_begin = double(chunk) * EVENT_CHUNK_SIZE;
+        double chunk_end = double(chunk + 1) * EVENT_CHUNK_SIZE;
+        size_t skip = border_events;
+        border_events = 0;
+        auto range = events.range(begin, end);
+        for (size_t i = range.first; i < range.second; ++i) {
+            if (skip > 0 && events.time(i) == chunk_begin) {
+                --skip;
+                continue;
+            }
+            event_vector.push_back(events.at(i));
+            if (events.time(i) == chunk_end) {
+                ++border_events;
             }
         }
     }
@@ -227,6 +240,38 @@ std::vector< std::experimental::optional< double > > rlib::common::
     return this->_statistic_cache[ t ];
 }
 
+std::vector< std::experimental::optional< double > > rlib::common::
+    cached_reader::statistic(
+        rlib::common::statistic_data t, double begin, double end)
+{
+    return this->_reader->statistic(t, begin, end);
+}
+
+std::vector< std::experimental::optional< double > > rlib::common::
+    cached_reader::quantile(double q, double begin, double end)
+{
+    return this->_reader->quantile(q, begin, end);
+}
+
+std::experimental::optional< double > rlib::common::cached_reader::integral(
+    size_t sensor, double begin, double end)
+{
+    return this->_reader->integral(sensor, begin, end);
+}
+
+std::experimental::optional< double > rlib::common::cached_reader::energy(
+    size_t current_sensor, size_t voltage_sensor, double begin, double end)
+{
+    return this->_reader->energy(current_sensor, voltage_sensor, begin, end);
+}
+
+std::experimental::optional< rlib::common::histogram > rlib::common::
+    cached_reader::histogram(
+        size_t sensor, double begin, double end, size_t bins)
+{
+    return this->_reader->histogram(sensor, begin, end, bins);
+}
+
 double rlib::common::cached_reader::length()
 {
     if (!this->_length_cache) {
@@ -235,6 +280,16 @@ double rlib::common::cached_reader::length()
     return this->_length_cache.value();
 }
 
+double rlib::common::cached_reader::loaded_until()
+{
+    return this->_reader->loaded_until();
+}
+
+double rlib::common::cached_reader::progress()
+{
+    return this->_reader->progress();
+}
+
 void rlib::common::cached_reader::reset()
 {
     this->_chunked_event_cache.clear();
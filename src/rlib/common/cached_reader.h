@@ -28,6 +28,7 @@
 
 // Own
 #include "rlib/common/event_data.h"
+#include "rlib/common/event_store.h"
 #include "rlib/common/reader.h"
 #include "rlib/common/sample.h"
 #include "rlib/common/sensor.h"
@@ -46,7 +47,7 @@ namespace rlib {
         class cached_reader : public reader {
             private:
             // Cache Datastruktures
-            std::map< int, std::vector< event_data > > _chunked_event_cache;
+            std::map< int, event_store > _chunked_event_cache;
             std::map< int, std::vector< common::sample > >
                 _chunked_sample_cache;
             std::map< int_fast32_t,
@@ -76,7 +77,22 @@ namespace rlib {
                 double begin, double end) override final;
             virtual std::vector< std::experimental::optional< double > >
                 statistic(statistic_data t) override final;
+            virtual std::vector< std::experimental::optional< double > >
+                statistic(statistic_data t, double begin, double end)
+                    override final;
+            virtual std::vector< std::experimental::optional< double > >
+                quantile(double q, double begin, double end) override final;
+            virtual std::experimental::optional< double > integral(
+                size_t sensor, double begin, double end) override final;
+            virtual std::experimental::optional< double > energy(
+                size_t current_sensor, size_t voltage_sensor, double begin,
+                double end) override final;
+            virtual std::experimental::optional< common::histogram > histogram(
+                size_t sensor, double begin, double end,
+                size_t bins) override final;
             virtual double length() override final;
+            virtual double loaded_until() override final;
+            virtual double progress() override final;
 
             void reset();
         };
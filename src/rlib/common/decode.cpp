@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Own
+#include "rlib/common/decode.h"
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+static void decode_f32_be_scalar(const char* src, size_t count, double* dst)
+{
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t raw;
+        std::memcpy(&raw, src + i * sizeof(raw), sizeof(raw));
+        raw = __builtin_bswap32(raw);
+        float value;
+        std::memcpy(&value, &raw, sizeof(value));
+        dst[ i ] = double(value);
+    }
+}
+
+static void encode_f32_be_scalar(const double* src, size_t count, char* dst)
+{
+    for (size_t i = 0; i < count; ++i) {
+        float value = float(src[ i ]);
+        uint32_t raw;
+        std::memcpy(&raw, &value, sizeof(raw));
+        raw = __builtin_bswap32(raw);
+        std::memcpy(dst + i * sizeof(raw), &raw, sizeof(raw));
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// SSE2 is part of x86_64, the byte swap is done with shifts as SSE2 has no
+// byte shuffle
+__attribute__((target("sse2"))) static void decode_f32_be_sse2(
+    const char* src, size_t count, double* dst)
+{
+    const __m128i low = _mm_set1_epi32(0x0000ff00);
+    const __m128i high = _mm_set1_epi32(0x00ff0000);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i raw = _mm_loadu_si128(
+            reinterpret_cast< const __m128i* >(src + i * sizeof(float)));
+        __m128i swapped = _mm_or_si128(
+            _mm_or_si128(_mm_slli_epi32(raw, 24), _mm_srli_epi32(raw, 24)),
+            _mm_or_si128(_mm_and_si128(_mm_slli_epi32(raw, 8), high),
+                _mm_and_si128(_mm_srli_epi32(raw, 8), low)));
+        __m128 values = _mm_castsi128_ps(swapped);
+        _mm_storeu_pd(dst + i, _mm_cvtps_pd(values));
+        _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(values, values)));
+    }
+    decode_f32_be_scalar(src + i * sizeof(float), count - i, dst + i);
+}
+
+__attribute__((target("avx2"))) static void decode_f32_be_avx2(
+    const char* src, size_t count, double* dst)
+{
+    const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9,
+        8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13,
+        12);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i raw = _mm256_loadu_si256(
+            reinterpret_cast< const __m256i* >(src + i * sizeof(float)));
+        __m256 values = _mm256_castsi256_ps(_mm256_shuffle_epi8(raw, swap));
+        _mm256_storeu_pd(
+            dst + i, _mm256_cvtps_pd(_mm256_castps256_ps128(values)));
+        _mm256_storeu_pd(
+            dst + i + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(values, 1)));
+    }
+    decode_f32_be_sse2(src + i * sizeof(float), count - i, dst + i);
+}
+
+__attribute__((target("sse2"))) static void encode_f32_be_sse2(
+    const double* src, size_t count, char* dst)
+{
+    const __m128i low = _mm_set1_epi32(0x0000ff00);
+    const __m128i high = _mm_set1_epi32(0x00ff0000);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 values = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(src + i)),
+            _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2)));
+        __m128i raw = _mm_castps_si128(values);
+        __m128i swapped = _mm_or_si128(
+            _mm_or_si128(_mm_slli_epi32(raw, 24), _mm_srli_epi32(raw, 24)),
+            _mm_or_si128(_mm_and_si128(_mm_slli_epi32(raw, 8), high),
+                _mm_and_si128(_mm_srli_epi32(raw, 8), low)));
+        _mm_storeu_si128(
+            reinterpret_cast< __m128i* >(dst + i * sizeof(float)), swapped);
+    }
+    encode_f32_be_scalar(src + i, count - i, dst + i * sizeof(float));
+}
+
+__attribute__((target("avx2"))) static void encode_f32_be_avx2(
+    const double* src, size_t count, char* dst)
+{
+    const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9,
+        8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13,
+        12);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 values = _mm256_insertf128_ps(
+            _mm256_castps128_ps256(_mm256_cvtpd_ps(_mm256_loadu_pd(src + i))),
+            _mm256_cvtpd_ps(_mm256_loadu_pd(src + i + 4)), 1);
+        _mm256_storeu_si256(
+            reinterpret_cast< __m256i* >(dst + i * sizeof(float)),
+            _mm256_shuffle_epi8(_mm256_castps_si256(values), swap));
+    }
+    encode_f32_be_sse2(src + i, count - i, dst + i * sizeof(float));
+}
+#endif
+
+bool rlib::common::kernel_supported(kernel k)
+{
+    switch (k) {
+        case kernel::SCALAR:
+            return true;
+#if defined(__x86_64__) || defined(__i386__)
+        case kernel::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case kernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#else
+        case kernel::SSE2:
+        case kernel::AVX2:
+            return false;
+#endif
+    }
+    return false;
+}
+
+rlib::common::kernel rlib::common::best_kernel()
+{
+    static const kernel best = kernel_supported(kernel::AVX2)
+        ? kernel::AVX2
+        : kernel_supported(kernel::SSE2) ? kernel::SSE2 : kernel::SCALAR;
+    return best;
+}
+
+void rlib::common::decode_f32_be(const char* src, size_t count, double* dst)
+{
+    decode_f32_be(src, count, dst, best_kernel());
+}
+
+void rlib::common::encode_f32_be(const double* src, size_t count, char* dst)
+{
+    encode_f32_be(src, count, dst, best_kernel());
+}
+
+void rlib::common::decode_f32_be(
+    const char* src, size_t count, double* dst, kernel k)
+{
+    switch (k) {
+#if defined(__x86_64__) || defined(__i386__)
+        case kernel::AVX2:
+            decode_f32_be_avx2(src, count, dst);
+            return;
+        case kernel::SSE2:
+            decode_f32_be_sse2(src, count, dst);
+            return;
+#else
+        case kernel::AVX2:
+        case kernel::SSE2:
+#endif
+        case kernel::SCALAR:
+            decode_f32_be_scalar(src, count, dst);
+            return;
+    }
+}
+
+void rlib::common::encode_f32_be(
+    const double* src, size_t count, char* dst, kernel k)
+{
+    switch (k) {
+#if defined(__x86_64__) || defined(__i386__)
+        case kernel::AVX2:
+            encode_f32_be_avx2(src, count, dst);
+            return;
+        case kernel::SSE2:
+            encode_f32_be_sse2(src, count, dst);
+            return;
+#else
+        case kernel::AVX2:
+        case kernel::SSE2:
+#endif
+        case kernel::SCALAR:
+            encode_f32_be_scalar(src, count, dst);
+            return;
+    }
+}
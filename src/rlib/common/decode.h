@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace rlib {
+    namespace common {
+        // Decode kernels converting blocks of packed binary values (as found
+        // in the records of dlog, psd and meta files) into doubles. Sources
+        // do not need to be aligned.
+
+        // Implementations of the f32 kernels. The overloads without a kernel
+        // use the fastest one supported by the cpu.
+        enum class kernel { SCALAR, SSE2, AVX2 };
+
+        // Whether the kernel can be used on this cpu (SCALAR always can)
+        bool kernel_supported(kernel k);
+        // The fastest kernel supported by this cpu
+        kernel best_kernel();
+
+        // Converts count contiguous big endian f32 values at src into dst.
+        // Uses AVX2 or SSE2 if available, otherwise a scalar byte swap.
+        void decode_f32_be(const char* src, size_t count, double* dst);
+        // Converts count doubles at src into contiguous big endian f32 values
+        // at dst (the inverse of decode_f32_be). Uses AVX2 or SSE2 if
+        // available, otherwise a scalar byte swap.
+        void encode_f32_be(const double* src, size_t count, char* dst);
+        // As above using the given kernel, which has to be supported
+        void decode_f32_be(
+            const char* src, size_t count, double* dst, kernel k);
+        void encode_f32_be(
+            const double* src, size_t count, char* dst, kernel k);
+
+        // Converts count values of type T (host byte order) at src, which
+        // are src_stride bytes apart (e.g. one column of fixed size records),
+        // into dst with dst_stride doubles between them. Contiguous columns
+        // are left to the auto vectorizer of the compiler.
+        template < class T >
+        void decode_strided(const char* src, size_t count, size_t src_stride,
+            double* dst, size_t dst_stride = 1)
+        {
+            if (src_stride == sizeof(T) && dst_stride == 1) {
+                for (size_t i = 0; i < count; ++i) {
+                    T value;
+                    std::memcpy(&value, src + i * sizeof(T), sizeof(T));
+                    dst[ i ] = double(value);
+                }
+                return;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                T value;
+                std::memcpy(&value, src + i * src_stride, sizeof(T));
+                dst[ i * dst_stride ] = double(value);
+            }
+        }
+    }
+}
@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Own
+#include "rlib/common/event_store.h"
+
+// StdLib
+#include <algorithm>
+#include <numeric>
+
+rlib::common::event_store::event_store()
+    : _raw_offsets{ 0 }
+{
+}
+
+uint32_t rlib::common::event_store::intern(std::string_view message)
+{
+    auto known = this->_message_index.find(message);
+    if (known != this->_message_index.end()) {
+        return known->second;
+    }
+    auto id = uint32_t(this->_messages.size());
+    this->_messages.emplace_back(message);
+    this->_message_index.emplace(this->_messages.back(), id);
+    return id;
+}
+
+void rlib::common::event_store::add(double time, event_data_level level,
+    int64_t origin, std::string_view message, const unsigned char* raw_data,
+    size_t raw_size)
+{
+    if (!this->_times.empty() && time < this->_times.back()) {
+        this->_sorted = false;
+    }
+    const size_t index = this->_times.size();
+    this->_times.push_back(time);
+    this->_origins.push_back(origin);
+    this->_levels.push_back(level);
+    this->_message_ids.push_back(this->intern(message));
+    this->_raw_data.insert(
+        this->_raw_data.end(), raw_data, raw_data + raw_size);
+    this->_raw_offsets.push_back(this->_raw_data.size());
+    this->_origin_index[ origin ].push_back(index);
+    this->_level_index[ level ].push_back(index);
+}
+
+void rlib::common::event_store::add(const event_data& event)
+{
+    this->add(event.time, event.event_level, event.origin, event.message,
+        event.raw_data.data(), event.raw_data.size());
+}
+
+void rlib::common::event_store::sort_by_time()
+{
+    if (this->_sorted) {
+        return;
+    }
+    std::vector< size_t > order(this->_times.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return this->_times[ a ] < this->_times[ b ];
+    });
+
+    // Messages are already interned, only the ids are reordered
+    event_store sorted;
+    sorted._messages = std::move(this->_messages);
+    sorted._message_index = std::move(this->_message_index);
+    sorted._raw_data.reserve(this->_raw_data.size());
+    for (auto index : order) {
+        const size_t sorted_index = sorted._times.size();
+        sorted._times.push_back(this->_times[ index ]);
+        sorted._origins.push_back(this->_origins[ index ]);
+        sorted._levels.push_back(this->_levels[ index ]);
+        sorted._message_ids.push_back(this->_message_ids[ index ]);
+        sorted._raw_data.insert(sorted._raw_data.end(),
+            this->_raw_data.begin() +
+                std::ptrdiff_t(this->_raw_offsets[ index ]),
+            this->_raw_data.begin() +
+                std::ptrdiff_t(this->_raw_offsets[ index + 1 ]));
+        sorted._raw_offsets.push_back(sorted._raw_data.size());
+        sorted._origin_index[ this->_origins[ index ] ].push_back(
+            sorted_index);
+        sorted._level_index[ this->_levels[ index ] ].push_back(sorted_index);
+    }
+    *this = std::move(sorted);
+}
+
+void rlib::common::event_store::clear()
+{
+    *this = event_store();
+}
+
+size_t rlib::common::event_store::size() const
+{
+    return this->_times.size();
+}
+
+bool rlib::common::event_store::empty() const
+{
+    return this->_times.empty();
+}
+
+double rlib::common::event_store::time(size_t index) const
+{
+    return this->_times[ index ];
+}
+
+rlib::common::event_data rlib::common::event_store::at(size_t index) const
+{
+    event_data event;
+    {
+        event.event_level = this->_levels[ index ];
+        event.time = this->_times[ index ];
+        event.origin = this->_origins[ index ];
+        event.message = this->_messages[ this->_message_ids[ index ] ];
+        event.raw_data.assign(this->_raw_data.begin() +
+                                  std::ptrdiff_t(this->_raw_offsets[ index ]),
+            this->_raw_data.begin() +
+                std::ptrdiff_t(this->_raw_offsets[ index + 1 ]));
+    }
+    return event;
+}
+
+std::pair< size_t, size_t > rlib::common::event_store::range(
+    double begin, double end) const
+{
+    auto first =
+        std::lower_bound(this->_times.begin(), this->_times.end(), begin);
+    auto last = this->_times.end();
+    if (end >= 0) {
+        last = std::upper_bound(first, this->_times.end(), end);
+    }
+    return { size_t(first - this->_times.begin()),
+        size_t(last - this->_times.begin()) };
+}
+
+std::vector< rlib::common::event_data > rlib::common::event_store::events(
+    double begin, double end) const
+{
+    auto range = this->range(begin, end);
+    std::vector< event_data > events;
+    events.reserve(range.second - range.first);
+    for (size_t i = range.first; i < range.second; ++i) {
+        events.push_back(this->at(i));
+    }
+    return events;
+}
+
+std::vector< rlib::common::event_data > rlib::common::event_store::select(
+    const std::vector< size_t >& indices, double begin, double end) const
+{
+    // Indices ascend like the times, so the range of the events is the range
+    // of the indices
+    auto range = this->range(begin, end);
+    auto first =
+        std::lower_bound(indices.begin(), indices.end(), range.first);
+    auto last = std::lower_bound(first, indices.end(), range.second);
+    std::vector< event_data > events;
+    events.reserve(size_t(last - first));
+    for (auto it = first; it != last; ++it) {
+        events.push_back(this->at(*it));
+    }
+    return events;
+}
+
+std::vector< rlib::common::event_data > rlib::common::event_store::
+    events_of_origin(double begin, double end, int64_t origin) const
+{
+    auto indices = this->_origin_index.find(origin);
+    if (indices == this->_origin_index.end()) {
+        return {};
+    }
+    return this->select(indices->second, begin, end);
+}
+
+std::vector< rlib::common::event_data > rlib::common::event_store::
+    events_of_level(double begin, double end, event_data_level level) const
+{
+    auto indices = this->_level_index.find(level);
+    if (indices == this->_level_index.end()) {
+        return {};
+    }
+    return this->select(indices->second, begin, end);
+}
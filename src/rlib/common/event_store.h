@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+#include "rlib/common/event_data.h"
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rlib {
+    namespace common {
+        // Events in columns ordered by time. Every distinct message is stored
+        // once (most events of a recording repeat a few messages) and the raw
+        // data of all events share one byte pool. Ranges of time are found
+        // by bisection, the events of each origin and of each level are
+        // indexed as well, so filtered ranges are bisections too.
+        class event_store {
+            private:
+            std::vector< double > _times;
+            std::vector< int64_t > _origins;
+            std::vector< event_data_level > _levels;
+            // Index of the message of each event in _messages
+            std::vector< uint32_t > _message_ids;
+            // Raw data of event i is _raw_data[ _raw_offsets[ i ] ] till
+            // _raw_data[ _raw_offsets[ i + 1 ] ]
+            std::vector< uint64_t > _raw_offsets;
+            std::vector< unsigned char > _raw_data;
+            // Distinct messages (a deque never moves its strings, so the
+            // views of _message_index stay valid)
+            std::deque< std::string > _messages;
+            std::unordered_map< std::string_view, uint32_t > _message_index;
+            // Ascending indices of the events of each origin and level
+            std::map< int64_t, std::vector< size_t > > _origin_index;
+            std::map< int64_t, std::vector< size_t > > _level_index;
+            bool _sorted = true;
+
+            private:
+            uint32_t intern(std::string_view message);
+            // Events of indices (ascending) from begin till end
+            std::vector< event_data > select(
+                const std::vector< size_t >& indices, double begin,
+                double end) const;
+
+            public:
+            event_store();
+            // Messages are viewed by _message_index, a copy would view the
+            // strings of the original
+            event_store(const event_store&) = delete;
+            event_store& operator=(const event_store&) = delete;
+            event_store(event_store&&) = default;
+            event_store& operator=(event_store&&) = default;
+
+            void add(double time, event_data_level level, int64_t origin,
+                std::string_view message, const unsigned char* raw_data,
+                size_t raw_size);
+            void add(const event_data& event);
+            // Restores the order of time (stable) after events were added out
+            // of order, has to be called before the store is queried
+            void sort_by_time();
+            void clear();
+
+            size_t size() const;
+            bool empty() const;
+            double time(size_t index) const;
+            event_data at(size_t index) const;
+            // Indices [first, last) of the events from begin (in seconds) till
+            // end (in seconds, < 0 => till the last event)
+            std::pair< size_t, size_t > range(double begin, double end) const;
+
+            std::vector< event_data > events(double begin, double end) const;
+            std::vector< event_data > events_of_origin(
+                double begin, double end, int64_t origin) const;
+            std::vector< event_data > events_of_level(
+                double begin, double end, event_data_level level) const;
+        };
+    }
+}
@@ -34,6 +34,10 @@
 namespace rlib {
     namespace common {
         class exporter {
+            protected:
+            // Length of the chunks (in seconds) streamed from the reader
+            constexpr static double EXPORT_CHUNK_LENGTH = 60.0;
+
             public:
             std::shared_ptr< common::reader > reader;
 
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Own
+#include "rlib/common/histogram.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+rlib::common::histogram::histogram(double min, double max, size_t bins)
+{
+    this->min = min;
+    this->max = max;
+    this->counts.resize(bins, 0);
+}
+
+size_t rlib::common::histogram::bins() const
+{
+    return this->counts.size();
+}
+
+size_t rlib::common::histogram::bin(double value) const
+{
+    const size_t bins = this->bins();
+    if (bins == 0 || !(value >= this->min && value <= this->max)) {
+        return bins;
+    }
+    if (!(this->max > this->min)) {
+        return 0;
+    }
+    double x = (value - this->min) / (this->max - this->min);
+    return std::min(bins - 1, size_t(x * double(bins)));
+}
+
+void rlib::common::histogram::add(double value)
+{
+    size_t bin = this->bin(value);
+    if (bin < this->bins()) {
+        ++this->counts[ bin ];
+    }
+}
+
+rlib::common::histogram& rlib::common::histogram::merge(
+    const rlib::common::histogram& other)
+{
+    if (other.counts.empty()) {
+        return *this;
+    }
+    if (this->counts.empty()) {
+        *this = other;
+        return *this;
+    }
+    if (this->bins() != other.bins() || this->min != other.min ||
+        this->max != other.max) {
+        throw std::runtime_error(
+            "Can not merge histograms with different bins");
+    }
+    for (size_t i = 0; i < this->counts.size(); ++i) {
+        this->counts[ i ] += other.counts[ i ];
+    }
+    return *this;
+}
+
+rlib::common::histogram rlib::common::histogram::coarsen(size_t bins) const
+{
+    if (bins == 0 || this->bins() % bins != 0) {
+        throw std::runtime_error("Can not coarsen histogram to " +
+                                 std::to_string(bins) + " bins");
+    }
+    const size_t width = this->bins() / bins;
+    rlib::common::histogram r(this->min, this->max, bins);
+    for (size_t i = 0; i < this->counts.size(); ++i) {
+        r.counts[ i / width ] += this->counts[ i ];
+    }
+    return r;
+}
@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rlib {
+    namespace common {
+        // Histogram with bins of equal width from min till max (the last bin
+        // includes max). NaN and values outside of [min, max] are not
+        // counted. Histograms with the same layout can be merged, a default
+        // constructed histogram adopts the layout of the first merged one.
+        class histogram {
+            public:
+            double min;
+            double max;
+            std::vector< uint64_t > counts;
+
+            public:
+            histogram(double min = 0.0, double max = 0.0, size_t bins = 0);
+
+            size_t bins() const;
+            // Bin of value (bins() if it is not counted)
+            size_t bin(double value) const;
+            void add(double value);
+            histogram& merge(const histogram& other);
+            // Histogram with bins bins, every bins() / bins neighbouring bins
+            // are combined (bins has to divide bins())
+            histogram coarsen(size_t bins) const;
+        };
+    }
+}
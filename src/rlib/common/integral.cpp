@@ -0,0 +1,201 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Own
+#include "rlib/common/integral.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+void rlib::common::compensated_sum::add(double value)
+{
+    double t = this->sum + value;
+    if (std::fabs(this->sum) >= std::fabs(value)) {
+        this->compensation += (this->sum - t) + value;
+    }
+    else {
+        this->compensation += (value - t) + this->sum;
+    }
+    this->sum = t;
+}
+
+rlib::common::compensated_sum& rlib::common::compensated_sum::merge(
+    const rlib::common::compensated_sum& other)
+{
+    this->add(other.sum);
+    this->add(other.compensation);
+    return *this;
+}
+
+double rlib::common::compensated_sum::value() const
+{
+    return this->sum + this->compensation;
+}
+
+double rlib::common::integrate(const rlib::common::sample& a,
+    const rlib::common::sample& b, const rlib::common::integrand& f,
+    double begin, double end)
+{
+    double lo = std::fmax(a.time, begin);
+    double hi = std::fmin(b.time, end);
+    if (!(lo < hi) || !(a.time < b.time)) {
+        return 0.0;
+    }
+    double fa = f(a);
+    double fb = f(b);
+    if (std::isnan(fa) || std::isnan(fb)) {
+        return 0.0;
+    }
+    double slope = (fb - fa) / (b.time - a.time);
+    double f_lo = fa + slope * (lo - a.time);
+    double f_hi = fa + slope * (hi - a.time);
+    return (hi - lo) * (f_lo + f_hi) / 2.0;
+}
+
+rlib::common::compensated_sum rlib::common::integrate(
+    const std::vector< rlib::common::sample >& data,
+    const rlib::common::integrand& f, double begin, double end)
+{
+    rlib::common::compensated_sum r;
+    for (size_t i = 1; i < data.size(); ++i) {
+        if (data[ i ].time <= begin) {
+            continue;
+        }
+        if (data[ i - 1 ].time >= end) {
+            break;
+        }
+        r.add(rlib::common::integrate(data[ i - 1 ], data[ i ], f, begin, end));
+    }
+    return r;
+}
+
+std::vector< rlib::common::sample > rlib::common::bracket(
+    rlib::common::reader& reader, double begin, double end, double margin)
+{
+    double length = reader.length();
+    margin = std::fmax(margin, 1e-9);
+    while (true) {
+        double lo = std::fmax(0.0, begin - margin);
+        double hi = std::fmin(length, end + margin);
+        auto data = reader.samples(lo, hi);
+        bool has_lo =
+            lo <= 0.0 || (!data.empty() && data.front().time <= begin);
+        bool has_hi =
+            hi >= length || (!data.empty() && data.back().time >= end);
+        if (has_lo && has_hi) {
+            return data;
+        }
+        margin *= 2.0;
+    }
+}
+
+rlib::common::block_integrator::block_integrator(
+    std::vector< rlib::common::integrand > integrands, double block_length)
+{
+    this->_integrands = integrands;
+    this->_block_length = block_length;
+    this->_blocks.resize(integrands.size());
+}
+
+void rlib::common::block_integrator::add(size_t block, size_t i, double value)
+{
+    auto& blocks = this->_blocks[ i ];
+    if (blocks.size() <= block) {
+        blocks.resize(block + 1);
+    }
+    blocks[ block ].add(value);
+}
+
+rlib::common::block_integrator::chunk rlib::common::block_integrator::
+    integrate(size_t block, const std::vector< rlib::common::sample >& data)
+        const
+{
+    chunk c;
+    {
+        c.block = block;
+        c.sums.resize(this->_integrands.size());
+    }
+    if (data.empty()) {
+        return c;
+    }
+    c.empty = false;
+    c.first = data.front();
+    c.last = data.back();
+    for (size_t i = 0; i < this->_integrands.size(); ++i) {
+        c.sums[ i ] = rlib::common::integrate(data, this->_integrands[ i ],
+            data.front().time, data.back().time);
+    }
+    return c;
+}
+
+void rlib::common::block_integrator::append(
+    const rlib::common::block_integrator::chunk& c)
+{
+    if (c.empty) {
+        return;
+    }
+    // The segment between the last sample of the previous chunk and the first
+    // sample of this chunk may span several blocks
+    if (this->_has_last) {
+        size_t first_block =
+            size_t(std::floor(this->_last.time / this->_block_length));
+        for (size_t block = first_block; block <= c.block; ++block) {
+            double lo = double(block) * this->_block_length;
+            double hi = double(block + 1) * this->_block_length;
+            for (size_t i = 0; i < this->_integrands.size(); ++i) {
+                this->add(block, i,
+                    rlib::common::integrate(this->_last, c.first,
+                        this->_integrands[ i ], lo, hi));
+            }
+        }
+    }
+    for (size_t i = 0; i < this->_integrands.size(); ++i) {
+        this->add(c.block, i, 0.0);
+        this->_blocks[ i ][ c.block ].merge(c.sums[ i ]);
+    }
+    this->_has_last = true;
+    this->_last = c.last;
+}
+
+std::vector< std::vector< double > > rlib::common::block_integrator::
+    prefix_sums(size_t blocks) const
+{
+    std::vector< std::vector< double > > r;
+    for (auto& integrals : this->_blocks) {
+        std::vector< double > prefix;
+        prefix.reserve(blocks + 1);
+        rlib::common::compensated_sum sum;
+        prefix.push_back(0.0);
+        for (size_t block = 0; block < blocks; ++block) {
+            if (block < integrals.size()) {
+                sum.merge(integrals[ block ]);
+            }
+            prefix.push_back(sum.value());
+        }
+        r.push_back(std::move(prefix));
+    }
+    return r;
+}
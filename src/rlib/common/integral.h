@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+#include "rlib/common/reader.h"
+#include "rlib/common/sample.h"
+
+// StdLib
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace rlib {
+    namespace common {
+        // Compensated (Kahan-Babuska-Neumaier) sum
+        class compensated_sum {
+            public:
+            double sum = 0.0;
+            double compensation = 0.0;
+
+            public:
+            void add(double value);
+            compensated_sum& merge(const compensated_sum& other);
+            double value() const;
+        };
+
+        // Function of a sample to integrate over time (e.g. the value of one
+        // sensor or the product of current and voltage)
+        using integrand = std::function< double(const sample&) >;
+
+        // Integral of f over time from begin (in seconds) till end (in
+        // seconds). f is linearly interpolated between neighbouring samples
+        // of data (sorted by time) and is 0 before the first and after the
+        // last sample. Segments with a NaN value are skipped.
+        compensated_sum integrate(const std::vector< sample >& data,
+            const integrand& f, double begin, double end);
+        // Integral of f over the segment between the samples a and b, clipped
+        // to begin (in seconds) till end (in seconds)
+        double integrate(const sample& a, const sample& b, const integrand& f,
+            double begin, double end);
+        // Reads the samples from begin (in seconds) till end (in seconds)
+        // including the closest samples before begin and after end (if any),
+        // which are needed to interpolate at the borders. The search starts
+        // with margin seconds and is widened until they are found.
+        std::vector< sample > bracket(
+            reader& reader, double begin, double end, double margin);
+
+        // Integrals of several integrands per block of block_length seconds
+        // (block k spans k * block_length till (k + 1) * block_length).
+        // Chunks of samples (one chunk per block) are integrated
+        // independently and appended in order, which adds the segments
+        // between the chunks.
+        class block_integrator {
+            public:
+            class chunk {
+                public:
+                size_t block;
+                bool empty = true;
+                sample first;
+                sample last;
+                std::vector< compensated_sum > sums;
+            };
+
+            private:
+            std::vector< integrand > _integrands;
+            double _block_length;
+            bool _has_last = false;
+            sample _last;
+            // Per integrand the integral of every block
+            std::vector< std::vector< compensated_sum > > _blocks;
+
+            private:
+            void add(size_t block, size_t i, double value);
+
+            public:
+            block_integrator(
+                std::vector< integrand > integrands, double block_length);
+
+            chunk integrate(
+                size_t block, const std::vector< sample >& data) const;
+            void append(const chunk& c);
+            // Per integrand the prefix sums of the block integrals (entry k
+            // is the integral from 0 till k * block_length)
+            std::vector< std::vector< double > > prefix_sums(
+                size_t blocks) const;
+        };
+    }
+}
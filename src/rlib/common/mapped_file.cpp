@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Own
+#include "rlib/common/mapped_file.h"
+
+// StdLib
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+rlib::common::mapped_file::mapped_file(
+    std::string filename, rlib::common::mapped_file::access hint)
+{
+    this->_filename = filename;
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Can not open file " + filename + ": " +
+                                 std::strerror(errno));
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Can not stat file " + filename + ": " +
+                                 std::strerror(errno));
+    }
+    this->_size = size_t(info.st_size);
+    // Empty files can not be mapped
+    if (this->_size > 0) {
+        void* data =
+            ::mmap(nullptr, this->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Can not map file " + filename + ": " +
+                                     std::strerror(errno));
+        }
+        this->_data = static_cast< const char* >(data);
+    }
+    // The mapping stays valid after closing the file descriptor
+    ::close(fd);
+    this->advise(hint);
+}
+
+rlib::common::mapped_file::~mapped_file()
+{
+    if (this->_data != nullptr) {
+        ::munmap(const_cast< char* >(this->_data), this->_size);
+    }
+}
+
+rlib::common::mapped_file::mapped_file(
+    rlib::common::mapped_file&& other) noexcept
+{
+    this->_filename = std::move(other._filename);
+    this->_data = other._data;
+    this->_size = other._size;
+    other._data = nullptr;
+    other._size = 0;
+}
+
+rlib::common::mapped_file& rlib::common::mapped_file::operator=(
+    rlib::common::mapped_file&& other) noexcept
+{
+    std::swap(this->_filename, other._filename);
+    std::swap(this->_data, other._data);
+    std::swap(this->_size, other._size);
+    return *this;
+}
+
+std::string rlib::common::mapped_file::filename() const
+{
+    return this->_filename;
+}
+
+const char* rlib::common::mapped_file::data() const
+{
+    return this->_data;
+}
+
+size_t rlib::common::mapped_file::size() const
+{
+    return this->_size;
+}
+
+void rlib::common::mapped_file::advise(
+    rlib::common::mapped_file::access hint, size_t offset, size_t length) const
+{
+    if (this->_data == nullptr || offset >= this->_size) {
+        return;
+    }
+    // madvise needs a page aligned address
+    const size_t page = size_t(::sysconf(_SC_PAGESIZE));
+    size_t begin = offset - offset % page;
+    size_t end = this->_size - offset < length ? this->_size : offset + length;
+
+    int advice = MADV_NORMAL;
+    switch (hint) {
+        case access::NORMAL:
+            advice = MADV_NORMAL;
+            break;
+        case access::SEQUENTIAL:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case access::RANDOM:
+            advice = MADV_RANDOM;
+            break;
+        case access::WILL_NEED:
+            advice = MADV_WILLNEED;
+            break;
+    }
+    // Hints are optional, so failures are ignored
+    ::madvise(const_cast< char* >(this->_data + begin), end - begin, advice);
+}
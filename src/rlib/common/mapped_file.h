@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace rlib {
+    namespace common {
+        // Read only memory mapping of a whole file. Any byte of the file can
+        // be accessed in O(1) without reading the preceding bytes, pages are
+        // loaded on demand and shared with the page cache.
+        class mapped_file {
+            public:
+            // Access pattern hints (see madvise)
+            enum class access { NORMAL, SEQUENTIAL, RANDOM, WILL_NEED };
+
+            private:
+            std::string _filename;
+            const char* _data = nullptr;
+            size_t _size = 0;
+
+            public:
+            mapped_file(std::string filename, access hint = access::NORMAL);
+            ~mapped_file();
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+            mapped_file(mapped_file&& other) noexcept;
+            mapped_file& operator=(mapped_file&& other) noexcept;
+
+            std::string filename() const;
+            const char* data() const;
+            size_t size() const;
+            // Hints the access pattern of length bytes from offset
+            void advise(access hint, size_t offset = 0,
+                size_t length = SIZE_MAX) const;
+
+            // Value of type T at offset (in byte order of the host, offset
+            // does not need to be aligned)
+            template < class T >
+            T read(size_t offset) const
+            {
+                T value;
+                std::memcpy(&value, this->_data + offset, sizeof(T));
+                return value;
+            }
+        };
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Own
+#include "rlib/common/output_buffer.h"
+
+// StdLib
+#include <algorithm>
+#include <charconv>
+
+rlib::common::output_buffer::output_buffer(std::ostream& output)
+    : _output(output)
+    , _buffer(BUFFER_SIZE)
+{
+}
+
+rlib::common::output_buffer::~output_buffer()
+{
+    this->write();
+}
+
+void rlib::common::output_buffer::append_double(double value, int precision)
+{
+    char* begin = this->reserve(NUMBER_LENGTH);
+    auto result = precision < 0
+                      ? std::to_chars(begin, begin + NUMBER_LENGTH, value)
+                      : std::to_chars(begin, begin + NUMBER_LENGTH, value,
+                            std::chars_format::general,
+                            std::min(precision, MAX_PRECISION));
+    this->commit(size_t(result.ptr - begin));
+}
+
+void rlib::common::output_buffer::append_integer(int64_t value)
+{
+    char* begin = this->reserve(NUMBER_LENGTH);
+    auto result = std::to_chars(begin, begin + NUMBER_LENGTH, value);
+    this->commit(size_t(result.ptr - begin));
+}
+
+void rlib::common::output_buffer::append_bytes(const void* data, size_t size)
+{
+    this->append(std::string_view(static_cast< const char* >(data), size));
+}
+
+char* rlib::common::output_buffer::reserve(size_t size)
+{
+    if (size > this->_buffer.size() - this->_size) {
+        this->write();
+    }
+    return this->_buffer.data() + this->_size;
+}
+
+void rlib::common::output_buffer::commit(size_t size)
+{
+    this->_size += size;
+}
+
+void rlib::common::output_buffer::write()
+{
+    if (this->_size > 0) {
+        this->_output.write(
+            this->_buffer.data(), std::streamsize(this->_size));
+        this->_size = 0;
+    }
+}
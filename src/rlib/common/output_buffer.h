@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace rlib {
+    namespace common {
+        // Collects the output of an exporter in a large buffer which is
+        // written to the stream in bulk. Numbers are formatted with
+        // std::to_chars (no locale, no stream state), the stream is never
+        // flushed.
+        class output_buffer {
+            public:
+            // Precision of the shortest representation which round trips
+            constexpr static int SHORTEST = -1;
+            // Significant digits which round trip any double
+            constexpr static int MAX_PRECISION = 17;
+
+            private:
+            constexpr static size_t BUFFER_SIZE = size_t(1) << 20;
+            // Max. length of a formatted number
+            constexpr static size_t NUMBER_LENGTH = 32;
+
+            std::ostream& _output;
+            std::vector< char > _buffer;
+            size_t _size = 0;
+
+            public:
+            explicit output_buffer(std::ostream& output);
+            // Writes what is left in the buffer
+            ~output_buffer();
+            output_buffer(const output_buffer&) = delete;
+            output_buffer& operator=(const output_buffer&) = delete;
+
+            void append(char c)
+            {
+                if (this->_size == this->_buffer.size()) {
+                    this->write();
+                }
+                this->_buffer[ this->_size++ ] = c;
+            }
+            void append(std::string_view text)
+            {
+                if (text.size() > this->_buffer.size() - this->_size) {
+                    this->write();
+                    if (text.size() > this->_buffer.size()) {
+                        this->_output.write(
+                            text.data(), std::streamsize(text.size()));
+                        return;
+                    }
+                }
+                std::memcpy(this->_buffer.data() + this->_size, text.data(),
+                    text.size());
+                this->_size += text.size();
+            }
+            // Appends value with precision significant digits (like
+            // std::setprecision, at most 17 which always round trip) or the
+            // shortest representation which round trips
+            void append_double(double value, int precision = SHORTEST);
+            void append_integer(int64_t value);
+            // Appends size raw bytes
+            void append_bytes(const void* data, size_t size);
+            // Space for size (<= 1 MiB) bytes at the end of the buffer which
+            // the caller fills and then appends with commit(size)
+            char* reserve(size_t size);
+            void commit(size_t size);
+
+            // Writes the buffer to the stream
+            void write();
+        };
+    }
+}
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+#include "rlib/common/reader.h"
+#include "rlib/common/sample.h"
+
+// StdLib
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace rlib {
+    namespace common {
+        // Streams the samples from begin (in seconds) till end (in seconds)
+        // of reader in chunks of chunk_length seconds. Chunks are read one
+        // after another (readers are not thread safe), each chunk is mapped
+        // to a partial result in parallel (bounded by the number of cores)
+        // and the partial results are reduced in chunk order.
+        template < class T, class MAP, class REDUCE >
+        void map_reduce_chunks(reader& reader, double begin, double end,
+            double chunk_length, T& result, MAP map, REDUCE reduce)
+        {
+            using partial = decltype(map(size_t(0),
+                std::declval< const std::vector< common::sample >& >()));
+            const size_t max_in_flight = std::max(
+                size_t(1), size_t(std::thread::hardware_concurrency()));
+            std::deque< std::future< partial > > futures;
+            reader.for_each_chunk(begin, end, chunk_length,
+                [&](size_t chunk, std::vector< common::sample >& data) {
+                    futures.emplace_back(std::async(std::launch::async,
+                        [&map, chunk, samples = std::move(data)]() {
+                            return map(chunk, samples);
+                        }));
+                    if (futures.size() >= max_in_flight) {
+                        reduce(result, futures.front().get());
+                        futures.pop_front();
+                    }
+                });
+            for (auto& future : futures) {
+                reduce(result, future.get());
+            }
+        }
+
+        // Splits the items [0, count) into slices of at least min_slice items
+        // (at most one slice per core) and calls slice(first, count) for
+        // every slice in parallel. Returns once all slices are done, slices
+        // writing to disjoint parts of a presized output keep the order of
+        // the items deterministic.
+        template < class SLICE >
+        void for_each_slice(size_t count, size_t min_slice, SLICE slice)
+        {
+            const size_t cores = std::max(
+                size_t(1), size_t(std::thread::hardware_concurrency()));
+            const size_t slices = std::min(cores,
+                std::max(size_t(1), count / std::max(size_t(1), min_slice)));
+            if (slices <= 1) {
+                if (count > 0) {
+                    slice(size_t(0), count);
+                }
+                return;
+            }
+            const size_t size = (count + slices - 1) / slices;
+            std::vector< std::future< void > > futures;
+            for (size_t first = size; first < count; first += size) {
+                futures.push_back(std::async(std::launch::async,
+                    [&slice, first, n = std::min(size, count - first)]() {
+                        slice(first, n);
+                    }));
+            }
+            // The first slice is decoded by the calling thread
+            slice(size_t(0), size);
+            for (auto& future : futures) {
+                future.get();
+            }
+        }
+    }
+}
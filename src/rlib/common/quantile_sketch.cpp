@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Own
+#include "rlib/common/quantile_sketch.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+rlib::common::quantile_sketch::quantile_sketch(double compression)
+{
+    this->_compression = compression;
+}
+
+void rlib::common::quantile_sketch::compress()
+{
+    if (!this->_buffer.empty()) {
+        this->rebuild();
+    }
+}
+
+void rlib::common::quantile_sketch::rebuild()
+{
+    if (this->_centroids.empty() && this->_buffer.empty()) {
+        return;
+    }
+    std::vector< centroid > all(this->_centroids);
+    all.reserve(all.size() + this->_buffer.size());
+    for (auto value : this->_buffer) {
+        all.push_back({ value, 1.0 });
+    }
+    this->_buffer.clear();
+    std::sort(all.begin(), all.end(),
+        [](const centroid& a, const centroid& b) { return a.mean < b.mean; });
+
+    // k1 scale function, a centroid may span at most one unit of k
+    const double total = double(this->_count);
+    auto k = [this](double q) {
+        return this->_compression / (2.0 * M_PI) * std::asin(2.0 * q - 1.0);
+    };
+
+    this->_centroids.clear();
+    double weight_so_far = 0.0;
+    centroid current = all.front();
+    double k_lower = k(0.0);
+    for (size_t i = 1; i < all.size(); ++i) {
+        const auto& next = all[ i ];
+        double q = std::fmin(
+            1.0, (weight_so_far + current.weight + next.weight) / total);
+        if (k(q) - k_lower <= 1.0) {
+            current.weight += next.weight;
+            current.mean +=
+                (next.mean - current.mean) * next.weight / current.weight;
+        }
+        else {
+            weight_so_far += current.weight;
+            k_lower = k(std::fmin(1.0, weight_so_far / total));
+            this->_centroids.push_back(current);
+            current = next;
+        }
+    }
+    this->_centroids.push_back(current);
+}
+
+void rlib::common::quantile_sketch::add(double value)
+{
+    if (std::isnan(value)) {
+        return;
+    }
+    ++this->_count;
+    this->_min = std::fmin(this->_min, value);
+    this->_max = std::fmax(this->_max, value);
+    this->_buffer.push_back(value);
+    if (this->_buffer.size() >= size_t(this->_compression * 10.0)) {
+        this->compress();
+    }
+}
+
+rlib::common::quantile_sketch& rlib::common::quantile_sketch::merge(
+    const rlib::common::quantile_sketch& other)
+{
+    if (other._count == 0) {
+        return *this;
+    }
+    this->_count += other._count;
+    this->_min = std::fmin(this->_min, other._min);
+    this->_max = std::fmax(this->_max, other._max);
+    this->_compression = std::fmax(this->_compression, other._compression);
+    this->_centroids.insert(this->_centroids.end(), other._centroids.begin(),
+        other._centroids.end());
+    this->_buffer.insert(
+        this->_buffer.end(), other._buffer.begin(), other._buffer.end());
+    this->rebuild();
+    return *this;
+}
+
+uint64_t rlib::common::quantile_sketch::count() const
+{
+    return this->_count;
+}
+
+double rlib::common::quantile_sketch::quantile(double q)
+{
+    this->compress();
+    if (this->_centroids.empty()) {
+        return std::numeric_limits< double >::quiet_NaN();
+    }
+    if (q <= 0.0) {
+        return this->_min;
+    }
+    if (q >= 1.0) {
+        return this->_max;
+    }
+
+    // Values are interpolated linearly between the centers of neighbouring
+    // centroids (and min/max at the borders)
+    const double index = q * double(this->_count);
+    double weight_so_far = 0.0;
+    double prev_center = 0.0;
+    double prev_mean = this->_min;
+    for (auto& c : this->_centroids) {
+        double center = weight_so_far + c.weight / 2.0;
+        if (index < center) {
+            double ratio = (index - prev_center) / (center - prev_center);
+            return prev_mean + (c.mean - prev_mean) * ratio;
+        }
+        weight_so_far += c.weight;
+        prev_center = center;
+        prev_mean = c.mean;
+    }
+    double total = double(this->_count);
+    if (!(total > prev_center)) {
+        return this->_max;
+    }
+    double ratio = (index - prev_center) / (total - prev_center);
+    return prev_mean + (this->_max - prev_mean) * ratio;
+}
@@ -23,6 +23,8 @@
 
 // Own
 #include "rlib/common/reader.h"
+#include "rlib/common/integral.h"
+#include "rlib/common/summary.h"
 
 // StdLib
 #include <algorithm>
@@ -168,6 +170,30 @@ rlib::common::sample rlib::common::reader::sample(double time, int_fast32_t r)
     return rlib::common::sample();
 }
 
+std::vector< rlib::common::event_data > rlib::common::reader::
+    events_of_origin(double begin, double end, int64_t origin)
+{
+    auto events = this->events(begin, end);
+    events.erase(std::remove_if(events.begin(), events.end(),
+                     [origin](const rlib::common::event_data& e) {
+                         return e.origin != origin;
+                     }),
+        events.end());
+    return events;
+}
+
+std::vector< rlib::common::event_data > rlib::common::reader::
+    events_of_level(double begin, double end, event_data_level level)
+{
+    auto events = this->events(begin, end);
+    events.erase(std::remove_if(events.begin(), events.end(),
+                     [level](const rlib::common::event_data& e) {
+                         return e.event_level != level;
+                     }),
+        events.end());
+    return events;
+}
+
 std::vector< std::experimental::optional< double > > rlib::common::reader::
     statistic(rlib::common::statistic_data t)
 {
@@ -175,3 +201,208 @@ std::vector< std::experimental::optional< double > > rlib::common::reader::
         this->sensors().size());
     return r;
 }
+
+std::vector< std::experimental::optional< double > > rlib::common::reader::
+    statistic(rlib::common::statistic_data t, double begin, double end)
+{
+    if (t == rlib::common::statistic_data::MEDIAN_VALUE) {
+        return rlib::common::reader::quantile(0.5, begin, end);
+    }
+    const size_t sensors = this->sensors().size();
+    std::vector< rlib::common::summary > summaries(sensors);
+    this->for_each_chunk(begin, end, std::fmax(this->length(), 1.0),
+        [&](size_t, std::vector< rlib::common::sample >& data) {
+            for (auto& datum : data) {
+                size_t count = std::min(sensors, datum.values.size());
+                for (size_t i = 0; i < count; ++i) {
+                    summaries[ i ].add(datum.values[ i ]);
+                }
+            }
+        });
+
+    std::vector< std::experimental::optional< double > > r;
+    for (auto& summary : summaries) {
+        r.push_back(summary.statistic(t));
+    }
+    return r;
+}
+
+std::vector< std::experimental::optional< double > > rlib::common::reader::
+    quantile(double q, double begin, double end)
+{
+    const size_t sensors = this->sensors().size();
+    std::vector< std::vector< double > > columns(sensors);
+    this->for_each_chunk(begin, end, std::fmax(this->length(), 1.0),
+        [&](size_t, std::vector< rlib::common::sample >& data) {
+            for (auto& datum : data) {
+                size_t count = std::min(sensors, datum.values.size());
+                for (size_t i = 0; i < count; ++i) {
+                    if (!std::isnan(datum.values[ i ])) {
+                        columns[ i ].push_back(datum.values[ i ]);
+                    }
+                }
+            }
+        });
+
+    // Linear interpolation between the closest ranks (the median of an even
+    // number of values is the mean of the two middle values)
+    q = std::fmin(1.0, std::fmax(0.0, q));
+    std::vector< std::experimental::optional< double > > r;
+    for (auto& column : columns) {
+        if (column.empty()) {
+            r.push_back({});
+            continue;
+        }
+        double index = q * double(column.size() - 1);
+        auto lo = column.begin() + std::ptrdiff_t(std::floor(index));
+        std::nth_element(column.begin(), lo, column.end());
+        double value = *lo;
+        if (lo + 1 != column.end() && index > std::floor(index)) {
+            double next = *std::min_element(lo + 1, column.end());
+            value += (next - value) * (index - std::floor(index));
+        }
+        r.push_back(value);
+    }
+    return r;
+}
+
+// Initial margin (in seconds) to search for the samples around a range
+static double bracket_margin(rlib::common::reader& reader)
+{
+    double margin = 1.0;
+    for (auto& sensor : reader.sensors()) {
+        if (sensor.sampling_interval > 0.0) {
+            margin = std::fmin(margin, sensor.sampling_interval);
+        }
+    }
+    return margin;
+}
+
+// Integral of f over the samples from begin (in seconds) till end (in seconds)
+static std::experimental::optional< double > integrate_range(
+    rlib::common::reader& reader, const rlib::common::integrand& f,
+    double begin, double end)
+{
+    double length = reader.length();
+    begin = std::fmax(begin, 0.0);
+    if (end < 0.0 || end > length) {
+        end = length;
+    }
+    if (begin > end) {
+        return {};
+    }
+    auto data =
+        rlib::common::bracket(reader, begin, end, bracket_margin(reader));
+    return rlib::common::integrate(data, f, begin, end).value();
+}
+
+// Value of a sensor (NaN if the sample has no value for it)
+static double value(const rlib::common::sample& datum, size_t sensor)
+{
+    if (sensor < datum.values.size()) {
+        return datum.values[ sensor ];
+    }
+    return std::nan("");
+}
+
+std::experimental::optional< double > rlib::common::reader::integral(
+    size_t sensor, double begin, double end)
+{
+    if (sensor >= this->sensors().size()) {
+        return {};
+    }
+    return integrate_range(*this,
+        [sensor](const rlib::common::sample& datum) {
+            return value(datum, sensor);
+        },
+        begin, end);
+}
+
+std::experimental::optional< double > rlib::common::reader::energy(
+    size_t current_sensor, size_t voltage_sensor, double begin, double end)
+{
+    const size_t sensors = this->sensors().size();
+    if (current_sensor >= sensors || voltage_sensor >= sensors) {
+        return {};
+    }
+    return integrate_range(*this,
+        [current_sensor, voltage_sensor](const rlib::common::sample& datum) {
+            return value(datum, current_sensor) * value(datum, voltage_sensor);
+        },
+        begin, end);
+}
+
+std::experimental::optional< rlib::common::histogram > rlib::common::reader::
+    histogram(size_t sensor, double begin, double end, size_t bins)
+{
+    if (sensor >= this->sensors().size() || bins == 0) {
+        return {};
+    }
+    auto min = this->statistic(rlib::common::statistic_data::MIN_VALUE);
+    auto max = this->statistic(rlib::common::statistic_data::MAX_VALUE);
+    if (sensor >= min.size() || sensor >= max.size() || !min[ sensor ] ||
+        !max[ sensor ]) {
+        min = rlib::common::reader::statistic(
+            rlib::common::statistic_data::MIN_VALUE, 0.0, -1.0);
+        max = rlib::common::reader::statistic(
+            rlib::common::statistic_data::MAX_VALUE, 0.0, -1.0);
+    }
+    if (!min[ sensor ] || !max[ sensor ]) {
+        return {};
+    }
+
+    rlib::common::histogram r(*min[ sensor ], *max[ sensor ], bins);
+    this->for_each_chunk(begin, end, std::fmax(this->length(), 1.0),
+        [&](size_t, std::vector< rlib::common::sample >& data) {
+            for (auto& datum : data) {
+                if (sensor < datum.values.size()) {
+                    r.add(datum.values[ sensor ]);
+                }
+            }
+        });
+    return r;
+}
+
+double rlib::common::reader::loaded_until()
+{
+    return this->length();
+}
+
+double rlib::common::reader::progress()
+{
+    return 1.0;
+}
+
+void rlib::common::reader::for_each_chunk(double begin, double end,
+    double chunk_length,
+    const std::function< void(size_t, std::vector< rlib::common::sample >&) >&
+        consumer)
+{
+    begin = std::fmax(begin, 0.0);
+    if (end < 0.0) {
+        end = this->length();
+    }
+    if (begin > end || chunk_length <= 0.0) {
+        return;
+    }
+
+    size_t first_chunk = size_t(std::floor(begin / chunk_length));
+    size_t last_chunk = size_t(std::floor(end / chunk_length));
+    for (size_t chunk = first_chunk; chunk <= last_chunk; ++chunk) {
+        double chunk_begin = std::fmax(begin, double(chunk) * chunk_length);
+        double chunk_end = std::fmin(end, double(chunk + 1) * chunk_length);
+        bool last = chunk == last_chunk;
+
+        auto data = this->samples(chunk_begin, chunk_end);
+        // Chunks are half open (except the last one) so samples on the border
+        // of two chunks are only passed once
+        data.erase(std::remove_if(data.begin(), data.end(),
+                       [&](const rlib::common::sample& datum) {
+                           return datum.time < chunk_begin ||
+                                  datum.time > chunk_end ||
+                                  (!last && !(datum.time < chunk_end));
+                       }),
+            data.end());
+        consumer(chunk, data);
+    }
+}
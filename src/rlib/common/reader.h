@@ -25,12 +25,14 @@
 
 // Own
 #include "rlib/common/event_data.h"
+#include "rlib/common/histogram.h"
 #include "rlib/common/sample.h"
 #include "rlib/common/sensor.h"
 
 // StdLib
 #include <cstdint>
 #include <experimental/optional>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -64,12 +66,60 @@ namespace rlib {
             virtual common::sample sample(double time);
             // Read data from time (in seconds) with Resolution r in Hz
             virtual common::sample sample(double time, int_fast32_t r);
-            // Read Events from begin (in seconds) till end (in seconds)
+            // Read Events from begin (in seconds) till end (in seconds). The
+            // origin of an event is the index of its sensor in sensors() (-1
+            // => global events), formats keeping events per channel report
+            // the first sensor of the channel.
             virtual std::vector< event_data > events(
                 double begin, double end) = 0;
+            // Events of origin (-1 => global events) from begin (in seconds)
+            // till end (in seconds)
+            virtual std::vector< event_data > events_of_origin(
+                double begin, double end, int64_t origin);
+            // Events of level from begin (in seconds) till end (in seconds)
+            virtual std::vector< event_data > events_of_level(
+                double begin, double end, event_data_level level);
             virtual std::vector< std::experimental::optional< double > >
                 statistic(statistic_data t);
+            // Statistic over the samples from begin (in seconds) till end (in
+            // seconds)
+            virtual std::vector< std::experimental::optional< double > >
+                statistic(statistic_data t, double begin, double end);
+            // Quantile q (0.0 <= q <= 1.0, e.g. 0.99 for p99) of every sensor
+            // over the samples from begin (in seconds) till end (in seconds)
+            virtual std::vector< std::experimental::optional< double > >
+                quantile(double q, double begin, double end);
+            // Integral of sensor over time from begin (in seconds) till end
+            // (in seconds), e.g. the charge of a current sensor. Samples are
+            // linearly interpolated.
+            virtual std::experimental::optional< double > integral(
+                size_t sensor, double begin, double end);
+            // Energy (integral of current * voltage over time) from begin (in
+            // seconds) till end (in seconds)
+            virtual std::experimental::optional< double > energy(
+                size_t current_sensor, size_t voltage_sensor, double begin,
+                double end);
+            // Histogram with bins bins of sensor over the samples from begin
+            // (in seconds) till end (in seconds). The bins span the MIN/MAX
+            // statistic of the sensor (over all samples), so histograms of
+            // different ranges share the same layout.
+            virtual std::experimental::optional< common::histogram > histogram(
+                size_t sensor, double begin, double end, size_t bins);
             virtual double length() = 0;
+            // Time (in seconds) up to which samples can be read without
+            // waiting for a loader still reading the file in the background
+            // (the length once everything is loaded)
+            virtual double loaded_until();
+            // Fraction (0.0 till 1.0) of the file loaded so far
+            virtual double progress();
+
+            // Read data from begin (in seconds) till end (in seconds) in
+            // chunks of chunk_length seconds. Chunks are aligned to multiples
+            // of chunk_length and every sample is passed to consumer exactly
+            // once together with the index of its chunk.
+            void for_each_chunk(double begin, double end, double chunk_length,
+                const std::function< void(
+                    size_t, std::vector< common::sample >&) >& consumer);
         };
     }
 }
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+
+// StdLib
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace rlib {
+    namespace common {
+        // Segment tree over the mergeable values T (e.g. summary). T must be
+        // default constructible as the empty value and provide a commutative
+        // merge(const T&). Queries over a range of leaves merge O(log n)
+        // nodes.
+        template < class T >
+        class segment_tree {
+            private:
+            size_t _size;
+            std::vector< T > _nodes;
+
+            public:
+            segment_tree(std::vector< T > leaves = {})
+                : _size(leaves.size())
+                , _nodes(2 * leaves.size())
+            {
+                for (size_t i = 0; i < this->_size; ++i) {
+                    this->_nodes[ this->_size + i ] = std::move(leaves[ i ]);
+                }
+                for (size_t i = this->_size - 1; 0 < i && i < this->_size;
+                     --i) {
+                    this->_nodes[ i ] = this->_nodes[ 2 * i ];
+                    this->_nodes[ i ].merge(this->_nodes[ 2 * i + 1 ]);
+                }
+            }
+
+            size_t size() const
+            {
+                return this->_size;
+            }
+
+            // Merge of the leaves [first, last)
+            T query(size_t first, size_t last) const
+            {
+                T r;
+                first += this->_size;
+                last += this->_size;
+                for (; first < last; first /= 2, last /= 2) {
+                    if (first % 2 == 1) {
+                        r.merge(this->_nodes[ first++ ]);
+                    }
+                    if (last % 2 == 1) {
+                        r.merge(this->_nodes[ --last ]);
+                    }
+                }
+                return r;
+            }
+        };
+    }
+}
@@ -24,100 +24,246 @@
 // Qt
 
 // Own
+#include "rlib/common/block_index.h"
+#include "rlib/common/parallel.h"
+#include "rlib/common/quantile_sketch.h"
 #include "rlib/common/statistic_reader.h"
+#include "rlib/common/summary.h"
 
 // StdLib
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
-#include <future>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <tuple>
 
-#include <iostream>
+double rlib::common::statistic_reader::chunk_length()
+{
+    double interval = std::numeric_limits< double >::infinity();
+    for (auto& sensor : this->_reader->sensors()) {
+        if (sensor.sampling_interval > 0.0) {
+            interval = std::fmin(interval, sensor.sampling_interval);
+        }
+    }
+    if (std::isinf(interval)) {
+        return DEFAULT_CHUNK_LENGTH;
+    }
+    return interval * double(CHUNK_SAMPLES);
+}
 
-void rlib::common::statistic_reader::analyse_data()
+rlib::common::block_index* rlib::common::statistic_reader::index()
 {
-    auto data = this->_reader->samples(0.0, -1.0);
-    if (data.empty()) {
-        return;
+    if (!this->_index) {
+        this->_index = std::make_unique< rlib::common::block_index >(
+            this->_reader, this->chunk_length());
     }
+    return this->_index.get();
+}
+
+std::vector< std::experimental::optional< double > > rlib::common::
+    statistic_reader::select_medians(double begin, double end)
+{
+    const auto summaries = this->index()->summaries(begin, end);
 
-    std::vector<
-        std::future< std::map< rlib::common::statistic_data, long double > > >
-        futures;
+    // The median is selected exactly without keeping all values in memory:
+    // every pass over the data builds a histogram of the remaining candidate
+    // range and narrows the range down to the bin containing the wanted rank,
+    // until the candidates are few enough to be selected in memory.
+    // Infinities are counted apart, the bins only span finite values.
+    class selection {
+        public:
+        size_t sensor;
+        uint64_t rank; // Rank within the candidates [lo, hi]
+        double lo;
+        double hi;
+        bool collect;
+        bool done;
+        double value;
+    };
+    class partial {
+        public:
+        std::vector< uint64_t > counts;
+        uint64_t neg_inf = 0;
+        uint64_t pos_inf = 0;
+        std::vector< double > lo;
+        std::vector< double > hi;
+        std::vector< double > values;
+    };
 
-    for (size_t sensor = 0; sensor < this->_reader->sensors().size();
-         ++sensor) {
-        futures.emplace_back(std::async(std::launch::deferred, [&, sensor]() {
-            std::vector< long double > sensorData;
+    std::vector< selection > selections;
+    for (size_t sensor = 0; sensor < summaries.size(); ++sensor) {
+        const auto& s = summaries[ sensor ];
+        if (s.count == 0) {
+            continue;
+        }
+        for (auto rank : { (s.count - 1) / 2, s.count / 2 }) {
+            selection sel;
             {
-                sensorData.reserve(data.size());
-            }
-            for (auto& d : data) {
-                sensorData.push_back(
-                    static_cast< long double >(d.values[ sensor ]));
+                sel.sensor = sensor;
+                sel.rank = rank;
+                sel.lo = s.min;
+                sel.hi = s.max;
+                sel.collect = s.count <= MEDIAN_CANDIDATES;
+                sel.done = !(s.min < s.max);
+                sel.value = s.min;
             }
-            std::sort(sensorData.begin(), sensorData.end());
-            long double avg =
-                std::accumulate(sensorData.begin(), sensorData.end(), 0.0L) /
-                static_cast< long double >(sensorData.size());
-            /*long double var = std::transform_reduce(std::execution::par,
-               sensorData.begin(), sensorData.end(), 1.0L, [](long double a,
-               long double b) { return
-               a + b; }, [avg](long double a) { return (a - avg) * (a - avg); })
-               / static_cast< long double >(sensorData.size());*/
-            long double var = 0.0L;
-            {
-                for (auto& d : sensorData) {
-                    var += (d - avg) * (d - avg);
+            selections.push_back(sel);
+        }
+    }
+
+    auto pending = [&selections]() {
+        return std::any_of(selections.begin(), selections.end(),
+            [](const selection& sel) { return !sel.done; });
+    };
+    while (pending()) {
+        std::vector< partial > result(selections.size());
+        rlib::common::map_reduce_chunks(*this->_reader, begin, end,
+            this->chunk_length(), result,
+            [&selections](
+                size_t, const std::vector< rlib::common::sample >& data) {
+                std::vector< partial > parts(selections.size());
+                for (size_t i = 0; i < selections.size(); ++i) {
+                    const auto& sel = selections[ i ];
+                    auto& part = parts[ i ];
+                    if (sel.done) {
+                        continue;
+                    }
+                    if (!sel.collect) {
+                        part.counts.resize(MEDIAN_BINS);
+                        part.lo.resize(MEDIAN_BINS,
+                            std::numeric_limits< double >::infinity());
+                        part.hi.resize(MEDIAN_BINS,
+                            -std::numeric_limits< double >::infinity());
+                    }
+                    const double lo = std::fmax(
+                        sel.lo, -std::numeric_limits< double >::max());
+                    const double hi = std::fmin(
+                        sel.hi, std::numeric_limits< double >::max());
+                    // Position of a value in [lo, hi] from 0.0 till 1.0, the
+                    // halves of a width overflowing a double do not overflow
+                    const double width = hi - lo;
+                    auto position = [lo, hi, width](double value) {
+                        if (!(width > 0.0)) {
+                            return 0.0;
+                        }
+                        if (std::isfinite(width)) {
+                            return (value - lo) / width;
+                        }
+                        return (value / 2.0 - lo / 2.0) / (hi / 2.0 - lo / 2.0);
+                    };
+                    for (auto& datum : data) {
+                        if (sel.sensor >= datum.values.size()) {
+                            continue;
+                        }
+                        double value = datum.values[ sel.sensor ];
+                        if (!(sel.lo <= value && value <= sel.hi)) {
+                            continue;
+                        }
+                        if (sel.collect) {
+                            part.values.push_back(value);
+                            continue;
+                        }
+                        if (std::isinf(value)) {
+                            ++(value < 0.0 ? part.neg_inf : part.pos_inf);
+                            continue;
+                        }
+                        size_t bin = std::min(MEDIAN_BINS - 1,
+                            size_t(position(value) * double(MEDIAN_BINS)));
+                        ++part.counts[ bin ];
+                        part.lo[ bin ] = std::fmin(part.lo[ bin ], value);
+                        part.hi[ bin ] = std::fmax(part.hi[ bin ], value);
+                    }
                 }
-                var /= static_cast< long double >(sensorData.size());
+                return parts;
+            },
+            [](std::vector< partial >& result,
+                const std::vector< partial >& parts) {
+                for (size_t i = 0; i < result.size(); ++i) {
+                    auto& r = result[ i ];
+                    const auto& p = parts[ i ];
+                    r.neg_inf += p.neg_inf;
+                    r.pos_inf += p.pos_inf;
+                    if (r.counts.empty()) {
+                        r.counts = p.counts;
+                        r.lo = p.lo;
+                        r.hi = p.hi;
+                    }
+                    else {
+                        for (size_t bin = 0; bin < p.counts.size(); ++bin) {
+                            r.counts[ bin ] += p.counts[ bin ];
+                            r.lo[ bin ] = std::fmin(r.lo[ bin ], p.lo[ bin ]);
+                            r.hi[ bin ] = std::fmax(r.hi[ bin ], p.hi[ bin ]);
+                        }
+                    }
+                    r.values.insert(
+                        r.values.end(), p.values.begin(), p.values.end());
+                }
+            });
+
+        for (size_t i = 0; i < selections.size(); ++i) {
+            auto& sel = selections[ i ];
+            auto& r = result[ i ];
+            if (sel.done) {
+                continue;
             }
-            long double min = sensorData[ 0 ];
-            long double max = sensorData[ sensorData.size() - 1 ];
-            long double median;
-            if (sensorData.size() % 2 == 0) {
-                median = (sensorData[ (sensorData.size() / 2) ] +
-                             sensorData[ (sensorData.size() / 2) - 1 ]) /
-                         2.0L;
+            if (sel.collect) {
+                if (sel.rank < r.values.size()) {
+                    std::nth_element(r.values.begin(),
+                        r.values.begin() + std::ptrdiff_t(sel.rank),
+                        r.values.end());
+                    sel.value = r.values[ sel.rank ];
+                }
+                sel.done = true;
+                continue;
             }
-            else {
-                median = sensorData[ (sensorData.size() / 2) ];
+            const uint64_t finite =
+                std::accumulate(r.counts.begin(), r.counts.end(), uint64_t(0));
+            if (sel.rank < r.neg_inf || sel.rank - r.neg_inf >= finite) {
+                sel.value = sel.rank < r.neg_inf
+                                ? -std::numeric_limits< double >::infinity()
+                                : std::numeric_limits< double >::infinity();
+                sel.done = true;
+                continue;
             }
-            std::map< rlib::common::statistic_data, long double > values;
-            {
-                values[ rlib::common::statistic_data::MIN_VALUE ] = min;
-                values[ rlib::common::statistic_data::MAX_VALUE ] = max;
-                values[ rlib::common::statistic_data::AVG_VALUE ] = avg;
-                values[ rlib::common::statistic_data::MEDIAN_VALUE ] = median;
-                values[ rlib::common::statistic_data::VAR_VALUE ] = var;
+            sel.rank -= r.neg_inf;
+            size_t bin = 0;
+            while (bin + 1 < r.counts.size() && sel.rank >= r.counts[ bin ]) {
+                sel.rank -= r.counts[ bin ];
+                ++bin;
             }
-            return values;
-        }));
+            // The bounds of a bin are values of it, the smallest and the
+            // largest candidate fall into different bins. A range which
+            // still is not narrowed is selected in memory.
+            const bool narrowed =
+                r.lo[ bin ] != sel.lo || r.hi[ bin ] != sel.hi;
+            sel.lo = r.lo[ bin ];
+            sel.hi = r.hi[ bin ];
+            sel.value = sel.lo;
+            sel.done = !(sel.lo < sel.hi);
+            sel.collect = r.counts[ bin ] <= MEDIAN_CANDIDATES || !narrowed;
+        }
     }
 
-    for (auto& future : futures) {
-        auto returnMap = future.get();
-        for (auto tuple : returnMap) {
-            rlib::common::statistic_data key = std::get< 0 >(tuple);
-            std::experimental::optional< double > opt;
-            if (std::isnormal(std::get< 1 >(tuple))) {
-                opt = std::experimental::make_optional(
-                    static_cast< double >(std::get< 1 >(tuple)));
-            }
-            this->_analysis_data[ key ].push_back(opt);
+    std::vector< std::experimental::optional< double > > medians(
+        summaries.size());
+    for (size_t i = 0; i + 1 < selections.size(); i += 2) {
+        double median =
+            (selections[ i ].value + selections[ i + 1 ].value) / 2.0;
+        if (std::isfinite(median)) {
+            medians[ selections[ i ].sensor ] = median;
         }
     }
+    return medians;
 }
 
 rlib::common::statistic_reader::statistic_reader(
     std::shared_ptr< reader > rawReader)
 {
     this->_reader = rawReader;
-    this->analyse_data();
 }
 
 std::string rlib::common::statistic_reader::filename()
@@ -148,19 +294,133 @@ std::vector< rlib::common::event_data > rlib::common::statistic_reader::events(
     return this->_reader->events(begin, end);
 }
 
+std::vector< rlib::common::event_data > rlib::common::statistic_reader::
+    events_of_origin(double begin, double end, int64_t origin)
+{
+    return this->_reader->events_of_origin(begin, end, origin);
+}
+
+std::vector< rlib::common::event_data > rlib::common::statistic_reader::
+    events_of_level(double begin, double end, event_data_level level)
+{
+    return this->_reader->events_of_level(begin, end, level);
+}
+
 std::vector< std::experimental::optional< double > > rlib::common::
     statistic_reader::statistic(rlib::common::statistic_data t)
 {
     auto s = this->_reader->statistic(t);
-    if (std::accumulate(s.begin(), s.end(), true, [](auto a, auto b) {
+    if (s.size() == this->sensors().size() &&
+        std::accumulate(s.begin(), s.end(), true, [](auto a, auto b) {
             return static_cast< bool >(a) & static_cast< bool >(b);
         })) {
         return s;
     }
-    return this->_analysis_data[ t ];
+
+    // Analyse lazily on the first request which the inner reader can not
+    // answer
+    if (t == rlib::common::statistic_data::MEDIAN_VALUE) {
+        if (!this->_medians) {
+            this->_medians = this->select_medians(0.0, -1.0);
+        }
+        return this->_medians.value();
+    }
+    std::vector< std::experimental::optional< double > > r;
+    for (auto& summary : this->index()->summaries()) {
+        r.push_back(summary.statistic(t));
+    }
+    return r;
+}
+
+std::vector< std::experimental::optional< double > > rlib::common::
+    statistic_reader::statistic(
+        rlib::common::statistic_data t, double begin, double end)
+{
+    if (t == rlib::common::statistic_data::MEDIAN_VALUE) {
+        return this->select_medians(begin, end);
+    }
+    std::vector< std::experimental::optional< double > > r;
+    for (auto& summary : this->index()->summaries(begin, end)) {
+        r.push_back(summary.statistic(t));
+    }
+    return r;
+}
+
+std::vector< std::experimental::optional< double > > rlib::common::
+    statistic_reader::quantile(double q, double begin, double end)
+{
+    auto sketches = this->index()->sketches(begin, end);
+    bool small = std::all_of(sketches.begin(), sketches.end(),
+        [](const rlib::common::quantile_sketch& sketch) {
+            return sketch.count() <= EXACT_QUANTILE_VALUES;
+        });
+    if (small) {
+        return this->exact_quantile(q, begin, end);
+    }
+    std::vector< std::experimental::optional< double > > r;
+    for (auto& sketch : sketches) {
+        double value = sketch.quantile(q);
+        if (std::isfinite(value)) {
+            r.push_back(value);
+        }
+        else {
+            r.push_back({});
+        }
+    }
+    return r;
+}
+
+std::vector< std::experimental::optional< double > > rlib::common::
+    statistic_reader::exact_quantile(double q, double begin, double end)
+{
+    return rlib::common::reader::quantile(q, begin, end);
+}
+
+std::experimental::optional< double > rlib::common::statistic_reader::
+    integral(size_t sensor, double begin, double end)
+{
+    return this->index()->integral(sensor, begin, end);
+}
+
+std::experimental::optional< double > rlib::common::statistic_reader::energy(
+    size_t current_sensor, size_t voltage_sensor, double begin, double end)
+{
+    return this->index()->energy(current_sensor, voltage_sensor, begin, end);
+}
+
+std::experimental::optional< rlib::common::histogram > rlib::common::
+    statistic_reader::histogram(
+        size_t sensor, double begin, double end, size_t bins)
+{
+    auto index = this->index();
+    if (!index->has_histograms()) {
+        auto min = this->statistic(rlib::common::statistic_data::MIN_VALUE);
+        auto max = this->statistic(rlib::common::statistic_data::MAX_VALUE);
+        std::vector< rlib::common::histogram > layouts;
+        for (size_t i = 0; i < min.size(); ++i) {
+            if (min[ i ] && max[ i ]) {
+                layouts.emplace_back(*min[ i ], *max[ i ], 1);
+            }
+            else {
+                layouts.emplace_back();
+            }
+        }
+        index->index_histograms(layouts);
+    }
+    return index->histogram(sensor, begin, end, bins);
 }
 
 double rlib::common::statistic_reader::length()
 {
     return this->_reader->length();
 }
+
+double rlib::common::statistic_reader::loaded_until()
+{
+    return this->_reader->loaded_until();
+}
+
+double rlib::common::statistic_reader::progress()
+{
+    return this->_reader->progress();
+}
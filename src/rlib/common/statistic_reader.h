@@ -24,10 +24,12 @@
 #pragma once
 
 // Own
+#include "rlib/common/block_index.h"
 #include "rlib/common/event_data.h"
 #include "rlib/common/reader.h"
 #include "rlib/common/sample.h"
 #include "rlib/common/sensor.h"
+#include "rlib/common/summary.h"
 
 // StdLib
 #include <cstdint>
@@ -42,15 +44,35 @@ namespace rlib {
     namespace common {
         class statistic_reader : public reader {
             private:
-            std::map< statistic_data,
+            // Samples per analysed chunk (if the sampling interval is known)
+            constexpr static size_t CHUNK_SAMPLES = 1 << 16;
+            // Chunk length in seconds (if the sampling interval is unknown)
+            constexpr static double DEFAULT_CHUNK_LENGTH = 5.0;
+            // Number of bins used per pass to narrow down the median
+            constexpr static size_t MEDIAN_BINS = 4096;
+            // Max. number of values per sensor kept in memory to select the
+            // median
+            constexpr static size_t MEDIAN_CANDIDATES = 1 << 16;
+            // Max. number of values in a range for which quantiles are
+            // computed exactly instead of using the quantile sketches
+            constexpr static uint64_t EXACT_QUANTILE_VALUES = 1 << 12;
+
+            // Lazy analysis results
+            std::unique_ptr< block_index > _index;
+            std::experimental::optional<
                 std::vector< std::experimental::optional< double > > >
-                _analysis_data;
+                _medians;
 
             public:
             std::shared_ptr< reader > _reader;
 
             private:
-            void analyse_data();
+            double chunk_length();
+            block_index* index();
+            // Exact medians of the samples from begin (in seconds) till end
+            // (in seconds), selected in passes over the range
+            std::vector< std::experimental::optional< double > > select_medians(
+                double begin, double end);
 
             public:
             statistic_reader(std::shared_ptr< reader > reader);
@@ -64,9 +86,41 @@ namespace rlib {
                 double begin, double end) override final;
             virtual std::vector< event_data > events(
                 double begin, double end) override final;
+            virtual std::vector< event_data > events_of_origin(
+                double begin, double end, int64_t origin) override final;
+            virtual std::vector< event_data > events_of_level(double begin,
+                double end, event_data_level level) override final;
             virtual std::vector< std::experimental::optional< double > >
                 statistic(statistic_data t) override final;
+            // Statistic of a range based on the block index, the median is
+            // exact like the one over all samples
+            virtual std::vector< std::experimental::optional< double > >
+                statistic(statistic_data t, double begin, double end)
+                    override final;
+            // Estimated quantile based on the quantile sketches of the block
+            // index (see quantile_sketch for the error bounds). Small ranges
+            // are answered exactly.
+            virtual std::vector< std::experimental::optional< double > >
+                quantile(double q, double begin, double end) override final;
+            // Exact quantile (scans every sample of the range)
+            std::vector< std::experimental::optional< double > >
+                exact_quantile(double q, double begin, double end);
+            // Integral based on the prefix sums of the block index, only the
+            // partial blocks at the edges are read
+            virtual std::experimental::optional< double > integral(
+                size_t sensor, double begin, double end) override final;
+            virtual std::experimental::optional< double > energy(
+                size_t current_sensor, size_t voltage_sensor, double begin,
+                double end) override final;
+            // Histogram merged from the block histograms of the block index
+            // (built on first use), only the partial blocks at the edges are
+            // read
+            virtual std::experimental::optional< common::histogram > histogram(
+                size_t sensor, double begin, double end,
+                size_t bins) override final;
             virtual double length() override final;
+            virtual double loaded_until() override final;
+            virtual double progress() override final;
         };
     }
 }
@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Own
+#include "rlib/common/summary.h"
+
+// StdLib
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <experimental/optional>
+#include <limits>
+
+void rlib::common::summary::add(double value)
+{
+    if (std::isnan(value)) {
+        return;
+    }
+    ++this->count;
+    long double delta = static_cast< long double >(value) - this->mean;
+    this->mean += delta / static_cast< long double >(this->count);
+    this->m2 += delta * (static_cast< long double >(value) - this->mean);
+    this->min = value < this->min ? value : this->min;
+    this->max = value > this->max ? value : this->max;
+}
+
+void rlib::common::summary::add(const double* values, size_t count)
+{
+    // Two passes over the block (sum, then squared deviations) keep the inner
+    // loops free of divisions and dependencies so they vectorize; the block
+    // is merged afterwards like any other partial summary.
+    rlib::common::summary block;
+    double sum = 0.0;
+    double min = std::numeric_limits< double >::infinity();
+    double max = -std::numeric_limits< double >::infinity();
+    for (size_t i = 0; i < count; ++i) {
+        double value = values[ i ];
+        if (value == value) {
+            sum += value;
+            ++block.count;
+            min = value < min ? value : min;
+            max = value > max ? value : max;
+        }
+    }
+    if (block.count == 0) {
+        return;
+    }
+    double mean = sum / double(block.count);
+    double m2 = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double value = values[ i ];
+        if (value == value) {
+            m2 += (value - mean) * (value - mean);
+        }
+    }
+    block.mean = static_cast< long double >(mean);
+    block.m2 = static_cast< long double >(m2);
+    block.min = min;
+    block.max = max;
+    this->merge(block);
+}
+
+rlib::common::summary& rlib::common::summary::merge(
+    const rlib::common::summary& other)
+{
+    if (other.count == 0) {
+        return *this;
+    }
+    if (this->count == 0) {
+        *this = other;
+        return *this;
+    }
+    long double n_a = static_cast< long double >(this->count);
+    long double n_b = static_cast< long double >(other.count);
+    long double n = n_a + n_b;
+    long double delta = other.mean - this->mean;
+    this->mean += delta * n_b / n;
+    this->m2 += other.m2 + delta * delta * n_a * n_b / n;
+    this->count += other.count;
+    this->min = other.min < this->min ? other.min : this->min;
+    this->max = other.max > this->max ? other.max : this->max;
+    return *this;
+}
+
+long double rlib::common::summary::variance() const
+{
+    if (this->count == 0) {
+        return std::numeric_limits< long double >::quiet_NaN();
+    }
+    return this->m2 / static_cast< long double >(this->count);
+}
+
+std::experimental::optional< double > rlib::common::summary::statistic(
+    rlib::common::statistic_data t) const
+{
+    long double value = std::numeric_limits< long double >::quiet_NaN();
+    if (this->count > 0) {
+        switch (t) {
+            case rlib::common::statistic_data::MIN_VALUE:
+                value = this->min;
+                break;
+            case rlib::common::statistic_data::MAX_VALUE:
+                value = this->max;
+                break;
+            case rlib::common::statistic_data::AVG_VALUE:
+                value = this->mean;
+                break;
+            case rlib::common::statistic_data::VAR_VALUE:
+                value = this->variance();
+                break;
+            default:
+                break;
+        }
+    }
+    if (!std::isfinite(value)) {
+        return {};
+    }
+    return static_cast< double >(value);
+}
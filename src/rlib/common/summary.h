@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+#include "rlib/common/reader.h"
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <experimental/optional>
+#include <limits>
+
+namespace rlib {
+    namespace common {
+        // Running statistic (count, mean, variance, min and max) of a value
+        // sequence. Summaries of different parts of a sequence can be merged
+        // (Chan et al.) without revisiting the values, so partial results of
+        // chunks can be computed independently.
+        class summary {
+            public:
+            uint64_t count = 0;
+            long double mean = 0.0L;
+            // Sum of squared differences from the mean
+            long double m2 = 0.0L;
+            double min = std::numeric_limits< double >::infinity();
+            double max = -std::numeric_limits< double >::infinity();
+
+            public:
+            // Adds a single value (Welford update). NaN is ignored.
+            void add(double value);
+            // Adds count contiguous values. NaN is ignored.
+            void add(const double* values, size_t count);
+            summary& merge(const summary& other);
+
+            long double variance() const;
+            // Value of the statistic t (if any). The median can not be
+            // derived from a summary.
+            std::experimental::optional< double > statistic(
+                statistic_data t) const;
+        };
+    }
+}
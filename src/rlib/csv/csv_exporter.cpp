@@ -22,13 +22,22 @@
  **/
 
 // Own
+#include "rlib/common/output_buffer.h"
 #include "rlib/csv/csv_exporter.h"
 
 // StdLib
 #include <cstdint>
-#include <iomanip>
 #include <iostream>
-#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+rlib::csv::csv_exporter::csv_exporter(
+    std::shared_ptr< common::reader > reader, int precision)
+    : common::exporter(std::move(reader))
+    , _precision(precision)
+{
+}
 
 // Export data from begin (in seconds) till end (in seconds) to output stream
 void rlib::csv::csv_exporter::data_export(
@@ -42,28 +51,38 @@ void rlib::csv::csv_exporter::data_export(
 void rlib::csv::csv_exporter::data_export(
     double begin, double end, int_fast32_t r, std::ostream& output)
 {
-    output << std::setprecision(
-        std::numeric_limits< long double >::digits10 + 1);
-    std::vector< rlib::common::sample > data;
-    if (r > 0) {
-        data = this->reader->samples(begin, end, r);
-    }
-    else {
-        data = this->reader->samples(begin, end);
-    }
+    // Rows are formatted into the buffer and written in bulk, the samples are
+    // streamed from the reader in chunks
+    rlib::common::output_buffer buffer(output);
 
     // Header
-    output << "time";
+    buffer.append("time");
     for (const auto& sensor : this->reader->sensors()) {
-        output << "," << sensor.name << " (" << sensor.unit << ")";
+        buffer.append(',');
+        buffer.append(sensor.name);
+        buffer.append(" (");
+        buffer.append(sensor.unit);
+        buffer.append(')');
     }
-    output << std::endl;
+    buffer.append('\n');
     // Content
-    for (const auto& datum : data) {
-        output << datum.time;
-        for (auto& value : datum.values) {
-            output << "," << value;
+    auto consume = [&](const std::vector< rlib::common::sample >& data) {
+        for (const auto& datum : data) {
+            buffer.append_double(datum.time, this->_precision);
+            for (auto value : datum.values) {
+                buffer.append(',');
+                buffer.append_double(value, this->_precision);
+            }
+            buffer.append('\n');
         }
-        output << std::endl;
+    };
+    if (r > 0) {
+        consume(this->reader->samples(begin, end, r));
+    }
+    else {
+        this->reader->for_each_chunk(begin, end, EXPORT_CHUNK_LENGTH,
+            [&](size_t, std::vector< rlib::common::sample >& data) {
+                consume(data);
+            });
     }
 }
@@ -25,15 +25,24 @@
 
 // Own
 #include "rlib/common/exporter.h"
+#include "rlib/common/output_buffer.h"
 
 // StdLib
 #include <cstdint>
 #include <iostream>
+#include <memory>
 
 namespace rlib::csv {
     class csv_exporter : public common::exporter {
+        private:
+        int _precision = common::output_buffer::SHORTEST;
+
         public:
         using common::exporter::exporter;
+        // precision is the number of significant digits of the times and
+        // values (output_buffer::SHORTEST => the shortest representation
+        // which reads back to the same double)
+        csv_exporter(std::shared_ptr< common::reader > reader, int precision);
 
         virtual void data_export(double begin, double end,
             std::ostream& output = std::cout) override final;
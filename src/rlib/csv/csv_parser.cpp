@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Own
+#include "rlib/csv/csv_parser.h"
+
+// StdLib
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+static const char* find_field_end_scalar(
+    const char* begin, const char* end, char delimiter)
+{
+    for (; begin != end; ++begin) {
+        if (*begin == delimiter || *begin == '\n') {
+            return begin;
+        }
+    }
+    return end;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2"))) static const char* find_field_end_sse2(
+    const char* begin, const char* end, char delimiter)
+{
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+    const __m128i newlines = _mm_set1_epi8('\n');
+    for (; end - begin >= 16; begin += 16) {
+        __m128i bytes =
+            _mm_loadu_si128(reinterpret_cast< const __m128i* >(begin));
+        int mask = _mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, delimiters),
+                _mm_cmpeq_epi8(bytes, newlines)));
+        if (mask != 0) {
+            return begin + __builtin_ctz(unsigned(mask));
+        }
+    }
+    return find_field_end_scalar(begin, end, delimiter);
+}
+#endif
+
+const char* rlib::csv::find_field_end(
+    const char* begin, const char* end, char delimiter)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    static const bool sse2 = __builtin_cpu_supports("sse2");
+    if (sse2) {
+        return find_field_end_sse2(begin, end, delimiter);
+    }
+#endif
+    return find_field_end_scalar(begin, end, delimiter);
+}
+
+const char* rlib::csv::next_line(const char* begin, const char* end)
+{
+    // memchr is vectorized by the C library
+    auto newline = static_cast< const char* >(
+        std::memchr(begin, '\n', size_t(end - begin)));
+    return newline == nullptr ? end : newline + 1;
+}
+
+double rlib::csv::parse_value(const char* begin, const char* end)
+{
+    while (begin != end && (*begin == ' ' || *begin == '\t')) {
+        ++begin;
+    }
+    // from_chars does not accept a leading plus (nor a sign after it)
+    if (begin != end && *begin == '+') {
+        ++begin;
+        if (begin != end && *begin == '-') {
+            return std::numeric_limits< double >::quiet_NaN();
+        }
+    }
+    double value;
+    auto result = std::from_chars(begin, end, value);
+    if (result.ec == std::errc::result_out_of_range) {
+        // Values rounded beyond the range of double (e.g. 1.8e308) read as
+        // infinity, underflows as zero (like strtod does)
+        value = std::strtod(std::string(begin, result.ptr).c_str(), nullptr);
+    }
+    else if (result.ec != std::errc()) {
+        return std::numeric_limits< double >::quiet_NaN();
+    }
+    for (auto rest = result.ptr; rest != end; ++rest) {
+        if (*rest != ' ' && *rest != '\t' && *rest != '\r') {
+            return std::numeric_limits< double >::quiet_NaN();
+        }
+    }
+    return value;
+}
+
+bool rlib::csv::parse_row(const char* begin, const char* end,
+    rlib::common::sample& datum, char delimiter)
+{
+    datum.values.clear();
+    // time
+    const char* field_end = find_field_end(begin, end, delimiter);
+    datum.time = parse_value(begin, field_end);
+    if (std::isnan(datum.time)) {
+        return false;
+    }
+    // values
+    while (field_end != end) {
+        begin = field_end + 1;
+        field_end = find_field_end(begin, end, delimiter);
+        datum.values.push_back(parse_value(begin, field_end));
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+#include "rlib/common/sample.h"
+
+// StdLib
+#include <cstddef>
+
+namespace rlib::csv {
+    // Tokenizer of csv rows working directly on the (mapped) bytes of the
+    // file, no line or field is copied.
+
+    // Position of the first delimiter or newline in [begin, end) (end if
+    // there is none). Scans 16 bytes at once with SSE2 if available.
+    const char* find_field_end(
+        const char* begin, const char* end, char delimiter);
+
+    // Position after the newline which ends the line at begin (end if the
+    // line is the last one)
+    const char* next_line(const char* begin, const char* end);
+
+    // Value of the number in [begin, end) (blanks around it are ignored),
+    // NaN if the field is no number. Values are rounded correctly, so
+    // decimals written with enough digits round trip exactly.
+    double parse_value(const char* begin, const char* end);
+
+    // Parses the row [begin, end) (without the newline) of the time and the
+    // values into datum. Returns false if the row has no valid time (e.g. an
+    // empty line).
+    bool parse_row(const char* begin, const char* end, common::sample& datum,
+        char delimiter = ',');
+}
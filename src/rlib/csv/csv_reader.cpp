@@ -21,77 +21,379 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **/
 
+// Ext
+#include <sys/stat.h>
+
 // Own
 #include "rlib/csv/csv_reader.h"
+#include "rlib/common/mapped_file.h"
+#include "rlib/common/parallel.h"
+#include "rlib/csv/csv_parser.h"
 
 // StdLib
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <utility>
 
-rlib::csv::csv_reader::csv_reader(std::string filename)
-    : _filename(filename)
-{
-    this->_async_loader = std::async(std::launch::async, [&]() {
-        std::ifstream csv_file(this->filename());
-        std::string line;
-        if (csv_file.good()) {
-            // Read first line to generate the Sensors
-            std::getline(csv_file, line);
-            std::istringstream value_stream(line);
-            std::string value;
-            // skip time
-            std::getline(value_stream, value, ',');
-            // values
-            while (getline(value_stream, value, ',')) {
-                rlib::common::sensor sensor;
+// Rows of a part of the csv in columns
+class csv_chunk {
+    public:
+    std::vector< double > times;
+    std::vector< double > values;
+};
+
+// Parses the rows in [pos, end) with width values each into chunk, lines
+// without a valid time are skipped
+static void parse_chunk(
+    const char* pos, const char* end, size_t width, csv_chunk& chunk)
+{
+    // The number of rows is estimated from the first (up to 16) lines. A row
+    // of width values takes at least width + 1 bytes, so no more rows than
+    // that are reserved however short the first lines are (rows with fewer
+    // values only grow the columns).
+    const size_t size = size_t(end - pos);
+    const char* sample_end = pos;
+    size_t lines = 0;
+    for (; lines < 16 && sample_end != end; ++lines) {
+        sample_end = rlib::csv::next_line(sample_end, end);
+    }
+    if (lines > 0) {
+        size_t rows = std::min(size * lines / size_t(sample_end - pos),
+            size / (width + 1));
+        chunk.times.reserve(rows);
+        chunk.values.reserve(rows * width);
+    }
+    rlib::common::sample datum;
+    while (pos != end) {
+        const char* line_end = rlib::csv::next_line(pos, end);
+        const char* row_end = line_end;
+        if (row_end != pos && row_end[ -1 ] == '\n') {
+            --row_end;
+        }
+        if (rlib::csv::parse_row(pos, row_end, datum)) {
+            datum.values.resize(width, std::nan(""));
+            chunk.times.push_back(datum.time);
+            chunk.values.insert(
+                chunk.values.end(), datum.values.begin(), datum.values.end());
+        }
+        pos = line_end;
+    }
+}
+
+// Splits the rows in [pos, end) at line starts into chunks of at least
+// min_bytes (and less than twice as many), returns the bounds of the chunks
+static std::vector< const char* > split_rows(
+    const char* pos, const char* end, size_t min_bytes)
+{
+    const size_t size = size_t(end - pos);
+    const size_t chunks = std::max(size_t(1), size / min_bytes);
+    std::vector< const char* > bounds = { pos };
+    for (size_t i = 1; i < chunks; ++i) {
+        const char* bound =
+            rlib::csv::next_line(pos + size * i / chunks - 1, end);
+        bounds.push_back(std::max(bounds.back(), bound));
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+rlib::csv::csv_reader::csv_reader(
+    std::string filename, csv_storage storage, bool persist_index)
+    : _storage(storage)
+    , _persist_index(persist_index)
+    , _filename(filename)
+{
+    auto sensor_loaded = std::make_shared< std::promise< void > >();
+    this->_async_loader_sensor = sensor_loaded->get_future().share();
+    this->_async_loader =
+        std::async(std::launch::async, [this, sensor_loaded]() {
+            try {
+                this->load(*sensor_loaded);
+            }
+            catch (...) {
+                // Callers waiting for the sensors or rows get the error
+                // instead of waiting forever
                 {
-                    // Get Name (and Unit)
-                    auto unit_begin = value.find_last_of("(");
-                    sensor.name = value.substr(0, unit_begin - 1);
-                    sensor.unit = value.substr(
-                        unit_begin + 1, value.size() - unit_begin - 2);
-                    sensor.sampling_interval = -1;
+                    std::lock_guard< std::mutex > lock(this->_loader_mutex);
+                    this->_loader_error = std::current_exception();
+                }
+                try {
+                    sensor_loaded->set_exception(std::current_exception());
+                }
+                catch (std::future_error&) {
+                    // The sensors were loaded already
                 }
-                this->_sensors.push_back(sensor);
             }
+            this->finish_loading();
+        });
+}
+
+rlib::csv::csv_reader::~csv_reader()
+{
+    // The loader uses the members, it has to end before they are destroyed
+    if (this->_async_loader.valid()) {
+        this->_async_loader.wait();
+    }
+}
+
+void rlib::csv::csv_reader::load(std::promise< void >& sensor_loaded)
+{
+    std::unique_ptr< rlib::common::mapped_file > csv_file;
+    try {
+        csv_file = std::make_unique< rlib::common::mapped_file >(
+            this->filename(),
+            rlib::common::mapped_file::access::SEQUENTIAL);
+    }
+    catch (std::runtime_error&) {
+        sensor_loaded.set_value();
+        return;
+    }
+    const char* pos = csv_file->data();
+    const char* end = pos + csv_file->size();
+    this->_total_bytes = csv_file->size();
+    if (pos != end) {
+        // Read first line to generate the Sensors
+        const char* line_end = rlib::csv::next_line(pos, end);
+        std::string line(pos, line_end);
+        pos = line_end;
+        while (!line.empty() &&
+               (line.back() == '\n' || line.back() == '\r')) {
+            line.pop_back();
         }
-        this->_async_loader_sensor_finished = true;
-        while (csv_file.good()) {
-            std::getline(csv_file, line);
-            std::istringstream value_stream(line);
-            std::string value;
-            rlib::common::sample datum;
+        std::istringstream value_stream(line);
+        std::string value;
+        // skip time
+        std::getline(value_stream, value, ',');
+        // values
+        while (getline(value_stream, value, ',')) {
+            rlib::common::sensor sensor;
             {
-                // time
-                std::getline(value_stream, value, ',');
-                datum.time = std::stod(value);
-                // values
-                while (std::getline(value_stream, value, ',')) {
-                    double v = double(std::stold(value));
-                    // Note: if v is NaN v != v is true
-                    if (v != v) {
-                        if (!value.empty() && value[ 0 ] == '-') {
-                            v = double(-NAN);
+                // Get Name (and Unit)
+                auto unit_begin = value.find_last_of("(");
+                sensor.name = value.substr(0, unit_begin - 1);
+                sensor.unit = value.substr(
+                    unit_begin + 1, value.size() - unit_begin - 2);
+                sensor.sampling_interval = -1;
+            }
+            this->_sensors.push_back(sensor);
+        }
+    }
+    // The sensors are available while the rows are still parsed
+    sensor_loaded.set_value();
+
+    this->_rows_offset = uint64_t(pos - csv_file->data());
+    if (this->_storage == csv_storage::INDEX) {
+        if (!this->_persist_index || !this->load_index()) {
+            this->index_rows(pos, end);
+            if (this->_persist_index) {
+                this->save_index();
+            }
+        }
+        this->_file = std::move(csv_file);
+        this->_file->advise(rlib::common::mapped_file::access::RANDOM);
+        return;
+    }
+
+    // The rows are parsed in batches of PARALLEL_BATCH_CHUNKS chunks. The
+    // chunks of a batch are split at line starts and parsed in parallel,
+    // then the batch is appended and published before the next one is read.
+    const size_t width = this->_sensors.size();
+    const size_t batch_bytes = PARALLEL_BATCH_CHUNKS * PARALLEL_CHUNK_BYTES;
+    while (pos != end) {
+        const char* batch_end = end;
+        if (size_t(end - pos) > batch_bytes) {
+            batch_end = rlib::csv::next_line(pos + batch_bytes - 1, end);
+        }
+        auto bounds = split_rows(pos, batch_end, PARALLEL_CHUNK_BYTES);
+        const size_t chunks = bounds.size() - 1;
+        std::vector< csv_chunk > parsed(chunks);
+        rlib::common::for_each_slice(
+            chunks, 1, [&](size_t first, size_t count) {
+                for (size_t i = first; i < first + count; ++i) {
+                    parse_chunk(
+                        bounds[ i ], bounds[ i + 1 ], width, parsed[ i ]);
+                }
+            });
+        {
+            std::lock_guard< std::mutex > lock(this->_loader_mutex);
+            for (auto& chunk : parsed) {
+                this->_times.insert(this->_times.end(),
+                    chunk.times.begin(), chunk.times.end());
+                this->_values.insert(this->_values.end(),
+                    chunk.values.begin(), chunk.values.end());
+            }
+            if (!this->_times.empty()) {
+                this->_loaded_until = this->_times.back();
+            }
+            this->_loaded_bytes = uint64_t(batch_end - csv_file->data());
+        }
+        this->_loader_progress.notify_all();
+        pos = batch_end;
+    }
+}
+
+// Size and modification time (in ns) of the file filename
+static bool file_version(
+    const std::string& filename, uint64_t& size, int64_t& time)
+{
+    struct stat status;
+    if (::stat(filename.c_str(), &status) != 0) {
+        return false;
+    }
+    size = uint64_t(status.st_size);
+    time = int64_t(status.st_mtim.tv_sec) * 1000000000 +
+           int64_t(status.st_mtim.tv_nsec);
+    return true;
+}
+
+void rlib::csv::csv_reader::finish_loading()
+{
+    {
+        std::lock_guard< std::mutex > lock(this->_loader_mutex);
+        this->_async_loader_finished = true;
+        this->_loaded_bytes = this->_total_bytes;
+    }
+    this->_loader_progress.notify_all();
+}
+
+void rlib::csv::csv_reader::wait_until_loaded(
+    std::unique_lock< std::mutex >& lock, double time)
+{
+    // Rows are ordered by time, once a row after time is loaded all rows
+    // till time are
+    this->_loader_progress.wait(lock, [&]() {
+        return this->_async_loader_finished ||
+               (time >= 0.0 && this->_loaded_until > time);
+    });
+    if (this->_loader_error) {
+        std::rethrow_exception(this->_loader_error);
+    }
+}
+
+std::string rlib::csv::csv_reader::index_filename()
+{
+    return this->_filename + ".idx";
+}
+
+bool rlib::csv::csv_reader::load_index()
+{
+    std::ifstream input(this->index_filename(), std::ios::binary);
+    char magic[ sizeof(INDEX_MAGIC) ] = {};
+    uint64_t size = 0;
+    int64_t time = 0;
+    uint64_t rows_offset = 0;
+    double length = 0.0;
+    uint64_t entries = 0;
+    input.read(magic, sizeof(magic));
+    input.read(reinterpret_cast< char* >(&size), sizeof(size));
+    input.read(reinterpret_cast< char* >(&time), sizeof(time));
+    input.read(reinterpret_cast< char* >(&rows_offset), sizeof(rows_offset));
+    input.read(reinterpret_cast< char* >(&length), sizeof(length));
+    input.read(reinterpret_cast< char* >(&entries), sizeof(entries));
+    // The index belongs to the csv as long as its size and modification
+    // time are unchanged
+    uint64_t csv_size;
+    int64_t csv_time;
+    if (!input.good() || std::memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0 ||
+        !file_version(this->_filename, csv_size, csv_time) ||
+        size != csv_size || time != csv_time ||
+        rows_offset != this->_rows_offset) {
+        return false;
+    }
+    // The entries have to fill the rest of the index file, a damaged count
+    // must not allocate
+    uint64_t index_size;
+    int64_t index_time;
+    const uint64_t header_size = uint64_t(input.tellg());
+    if (!file_version(this->index_filename(), index_size, index_time) ||
+        index_size < header_size ||
+        entries != (index_size - header_size) / sizeof(index_entry) ||
+        (index_size - header_size) % sizeof(index_entry) != 0) {
+        return false;
+    }
+    std::vector< index_entry > index(entries);
+    input.read(reinterpret_cast< char* >(index.data()),
+        std::streamsize(entries * sizeof(index_entry)));
+    if (!input.good()) {
+        return false;
+    }
+    this->_index = std::move(index);
+    this->_length = length;
+    return true;
+}
+
+void rlib::csv::csv_reader::save_index()
+{
+    uint64_t size;
+    int64_t time;
+    uint64_t entries = this->_index.size();
+    if (!file_version(this->_filename, size, time)) {
+        return;
+    }
+    // A failed write only costs the next scan
+    std::ofstream output(this->index_filename(), std::ios::binary);
+    output.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    output.write(reinterpret_cast< const char* >(&size), sizeof(size));
+    output.write(reinterpret_cast< const char* >(&time), sizeof(time));
+    output.write(reinterpret_cast< const char* >(&this->_rows_offset),
+        sizeof(this->_rows_offset));
+    output.write(
+        reinterpret_cast< const char* >(&this->_length), sizeof(this->_length));
+    output.write(reinterpret_cast< const char* >(&entries), sizeof(entries));
+    output.write(reinterpret_cast< const char* >(this->_index.data()),
+        std::streamsize(entries * sizeof(index_entry)));
+}
+
+void rlib::csv::csv_reader::index_rows(const char* pos, const char* end)
+{
+    // Chunks are indexed in parallel, only the time of the rows is parsed.
+    // Every chunk starts with an entry, then one every INDEX_STRIDE rows.
+    const char* data = pos - this->_rows_offset;
+    auto bounds = split_rows(pos, end, PARALLEL_CHUNK_BYTES);
+    const size_t chunks = bounds.size() - 1;
+    std::vector< std::vector< index_entry > > indices(chunks);
+    std::vector< double > last_times(
+        chunks, std::numeric_limits< double >::quiet_NaN());
+    rlib::common::for_each_slice(chunks, 1, [&](size_t first, size_t count) {
+        for (size_t i = first; i < first + count; ++i) {
+            size_t rows = 0;
+            for (const char* row = bounds[ i ]; row != bounds[ i + 1 ];) {
+                const char* line_end =
+                    rlib::csv::next_line(row, bounds[ i + 1 ]);
+                double time = rlib::csv::parse_value(
+                    row, rlib::csv::find_field_end(row, line_end, ','));
+                if (!std::isnan(time)) {
+                    if (rows % INDEX_STRIDE == 0) {
+                        index_entry entry;
+                        {
+                            entry.time = time;
+                            entry.offset = uint64_t(row - data);
                         }
+                        indices[ i ].push_back(entry);
                     }
-                    else {
-                        size_t precision =
-                            value.size() - value.find_first_of('.');
-                        v = std::round(v * std::pow(10.0, precision)) /
-                            std::pow(10.0, precision);
-                    }
-                    datum.values.push_back(v);
+                    last_times[ i ] = time;
+                    ++rows;
                 }
+                row = line_end;
             }
-            this->_data.push_back(datum);
         }
-        this->_async_loader_finished = true;
     });
+    for (size_t i = 0; i < chunks; ++i) {
+        this->_index.insert(
+            this->_index.end(), indices[ i ].begin(), indices[ i ].end());
+        if (!std::isnan(last_times[ i ])) {
+            this->_length = last_times[ i ];
+        }
+    }
 }
 
 std::string rlib::csv::csv_reader::filename()
@@ -101,33 +403,74 @@ std::string rlib::csv::csv_reader::filename()
 
 std::vector< rlib::common::sensor > rlib::csv::csv_reader::sensors()
 {
-    if (!this->_async_loader_sensor_finished) {
-        this->_async_loader.wait();
-    }
+    this->_async_loader_sensor.get();
     return this->_sensors;
 }
 
 std::vector< rlib::common::sample > rlib::csv::csv_reader::samples(
     double begin, double end)
 {
-    if (!this->_async_loader_finished) {
-        this->_async_loader.wait();
-    }
     if (begin < 0) {
         begin = 0;
     }
     if (end < 0) {
         end = this->length();
     }
+    // Ranges which are loaded already are returned while the loader goes on
+    std::unique_lock< std::mutex > lock(this->_loader_mutex);
+    this->wait_until_loaded(lock, end);
+
+    // Rows are ordered by time
+    const size_t width = this->_sensors.size();
     std::vector< rlib::common::sample > return_data;
-    for (auto& d : this->_data) {
-        if (d.time < begin) {
-            continue;
+    if (this->_storage == csv_storage::INDEX) {
+        // The index is complete once loaded, rows are read from the file
+        lock.unlock();
+        if (!this->_file) {
+            return return_data;
+        }
+        // Rows are parsed from the last index entry before begin
+        auto entry = std::lower_bound(this->_index.begin(), this->_index.end(),
+            begin, [](const index_entry& e, double time) {
+                return e.time < time;
+            });
+        if (entry != this->_index.begin()) {
+            --entry;
         }
-        if (d.time > end) {
-            break;
+        const char* data = this->_file->data();
+        const char* pos = data + (entry != this->_index.end()
+                                         ? entry->offset
+                                         : this->_rows_offset);
+        const char* data_end = data + this->_file->size();
+        rlib::common::sample datum;
+        while (pos != data_end) {
+            const char* line_end = rlib::csv::next_line(pos, data_end);
+            const char* row_end = line_end;
+            if (row_end != pos && row_end[ -1 ] == '\n') {
+                --row_end;
+            }
+            bool valid = rlib::csv::parse_row(pos, row_end, datum);
+            pos = line_end;
+            if (!valid || datum.time < begin) {
+                continue;
+            }
+            if (datum.time > end) {
+                break;
+            }
+            datum.values.resize(width, std::nan(""));
+            return_data.push_back(datum);
         }
-        return_data.push_back(d);
+        return return_data;
+    }
+    auto first =
+        std::lower_bound(this->_times.begin(), this->_times.end(), begin);
+    auto last = std::upper_bound(first, this->_times.end(), end);
+    return_data.reserve(size_t(last - first));
+    for (auto it = first; it != last; ++it) {
+        auto row = this->_values.begin() +
+                   (it - this->_times.begin()) * std::ptrdiff_t(width);
+        return_data.emplace_back(
+            *it, std::vector< double >(row, row + std::ptrdiff_t(width)));
     }
     return return_data;
 }
@@ -140,12 +483,31 @@ std::vector< rlib::common::event_data > rlib::csv::csv_reader::events(
 
 double rlib::csv::csv_reader::length()
 {
-    if (!this->_async_loader_finished) {
-        this->_async_loader.wait();
-    }
-    double length = 0.0;
-    if (!this->_data.empty()) {
-        length = this->_data.at(this->_data.size() - 1).time;
+    std::unique_lock< std::mutex > lock(this->_loader_mutex);
+    this->wait_until_loaded(lock, -1.0);
+    double length = this->_length;
+    if (!this->_times.empty()) {
+        length = this->_times.back();
     }
     return length;
 }
+
+double rlib::csv::csv_reader::loaded_until()
+{
+    {
+        std::lock_guard< std::mutex > lock(this->_loader_mutex);
+        if (!this->_async_loader_finished) {
+            return this->_loaded_until;
+        }
+    }
+    return this->length();
+}
+
+double rlib::csv::csv_reader::progress()
+{
+    std::lock_guard< std::mutex > lock(this->_loader_mutex);
+    if (this->_async_loader_finished || this->_total_bytes == 0) {
+        return this->_async_loader_finished ? 1.0 : 0.0;
+    }
+    return double(this->_loaded_bytes) / double(this->_total_bytes);
+}
@@ -24,6 +24,7 @@
 #pragma once
 
 // Own
+#include "rlib/common/mapped_file.h"
 #include "rlib/common/reader.h"
 #include "rlib/common/sample.h"
 #include "rlib/common/sensor.h"
@@ -31,26 +32,102 @@
 // StdLib
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <vector>
 
 namespace rlib::csv {
+    // Where the rows of a csv are kept
+    enum class csv_storage {
+        // All rows are parsed into memory once
+        MEMORY,
+        // Only every INDEX_STRIDE-th row is indexed (time and offset in the
+        // file), rows of a range are parsed from the file when requested
+        INDEX
+    };
+
     class csv_reader : public common::reader {
         private:
+        // Min. number of bytes parsed by one thread
+        constexpr static size_t PARALLEL_CHUNK_BYTES = 4 << 20;
+        // Number of chunks parsed in parallel and published at once while
+        // the rows are loaded
+        constexpr static size_t PARALLEL_BATCH_CHUNKS = 4;
+        // Number of rows between two entries of the sparse index
+        constexpr static size_t INDEX_STRIDE = 1024;
+        // Start of a persisted index (version 1)
+        constexpr static char INDEX_MAGIC[ 8 ] = { 'R', 'L', 'C', 'S', 'V',
+            'I', 'X', '1' };
+
+        // Row of the sparse index
+        class index_entry {
+            public:
+            double time;
+            // Offset of the row in the file in bytes
+            uint64_t offset;
+        };
+
+        csv_storage _storage;
+        bool _persist_index;
         std::vector< common::sensor > _sensors;
-        std::vector< common::sample > _data;
+        // Rows are stored as columns, the time of every row and the values
+        // of all rows (one value per sensor, missing values are NaN)
+        std::vector< double > _times;
+        std::vector< double > _values;
+        // Only used with csv_storage::INDEX
+        std::unique_ptr< common::mapped_file > _file;
+        std::vector< index_entry > _index;
+        // Offset of the first row in bytes
+        uint64_t _rows_offset = 0;
+        double _length = 0.0;
         std::vector< common::event_data > _events;
         std::string _filename;
 
         std::future< void > _async_loader;
+        std::shared_future< void > _async_loader_sensor;
+        // Guards the rows and the progress while the loader appends rows
+        std::mutex _loader_mutex;
+        std::condition_variable _loader_progress;
         bool _async_loader_finished = false;
-        bool _async_loader_sensor_finished = false;
+        // Time of the last row loaded so far
+        double _loaded_until = 0.0;
+        uint64_t _loaded_bytes = 0;
+        uint64_t _total_bytes = 0;
+        // Error which ended the loader, rethrown to the callers
+        std::exception_ptr _loader_error;
+
+        private:
+        // Reads the sensors and the rows (or their index), runs
+        // asynchronously
+        void load(std::promise< void >& sensor_loaded);
+        void finish_loading();
+        // Waits till all rows until time (in seconds, < 0 => all rows) are
+        // loaded
+        void wait_until_loaded(
+            std::unique_lock< std::mutex >& lock, double time);
+        // Name of the file the sparse index is persisted to
+        std::string index_filename();
+        // Loads the persisted index, false if there is none for this version
+        // of the csv
+        bool load_index();
+        void save_index();
+        // Builds the sparse index of the rows in [pos, end)
+        void index_rows(const char* pos, const char* end);
 
         public:
-        csv_reader(std::string filename);
-        virtual ~csv_reader() override = default;
+        // With persist_index the sparse index is stored next to the csv
+        // (filename.idx) and reused as long as the csv does not change
+        csv_reader(std::string filename,
+            csv_storage storage = csv_storage::MEMORY,
+            bool persist_index = false);
+        virtual ~csv_reader() override;
 
         virtual std::string filename() override final;
         virtual std::vector< common::sensor > sensors() override final;
@@ -59,5 +136,7 @@ namespace rlib::csv {
         virtual std::vector< common::event_data > events(
             double begin, double end) override final;
         virtual double length() override final;
+        virtual double loaded_until() override final;
+        virtual double progress() override final;
     };
 }
@@ -35,43 +35,70 @@
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 rlib::keysight::dlog::dlog(std::string _filename)
 {
     this->filename = _filename;
 
-    // Read XML Part of the dlog
+    // Read XML Part of the dlog (only the header till the line containing
+    // </dlog>, the binary payload follows after this line)
+    const std::string endTag = "</dlog>";
+    std::ifstream stream(this->filename, std::ios::binary);
+    if (!stream) {
+        throw std::runtime_error("Can not open dlog file " + this->filename);
+    }
     std::string dlogXmlString;
-    std::ifstream txtstream(this->filename.c_str());
-    std::string line;
-    do {
-        std::getline(txtstream, line);
-        // HOTFIX: Make Invalid xml valid again ...
-        if (line.find("<1ua>") != std::string::npos) {
-            line.replace(
-                line.find("<1ua>"), std::string("<1ua>").size(), "<FIXME_1ua>");
+    std::vector< char > buffer(HEADER_CHUNK_SIZE);
+    size_t endPos = std::string::npos;
+    size_t lineEndPos = std::string::npos;
+    while (lineEndPos == std::string::npos) {
+        stream.read(buffer.data(), std::streamsize(buffer.size()));
+        size_t count = size_t(stream.gcount());
+        if (count == 0) {
+            break;
         }
-        if (line.find("</1ua>") != std::string::npos) {
-            line.replace(line.find("</1ua>"), std::string("</1ua>").size(),
-                "</FIXME_1ua>");
+        size_t searchPos = dlogXmlString.size() < endTag.size()
+                               ? 0
+                               : dlogXmlString.size() - endTag.size();
+        dlogXmlString.append(buffer.data(), count);
+        if (endPos == std::string::npos) {
+            endPos = dlogXmlString.find(endTag, searchPos);
         }
-        if (line.find("<2ua>") != std::string::npos) {
-            line.replace(
-                line.find("<2ua>"), std::string("<2ua>").size(), "<FIXME_2ua>");
+        if (endPos != std::string::npos) {
+            lineEndPos = dlogXmlString.find('\n', endPos);
         }
-        if (line.find("</2ua>") != std::string::npos) {
-            line.replace(line.find("</2ua>"), std::string("</2ua>").size(),
-                "</FIXME_2ua>");
+    }
+    if (endPos == std::string::npos) {
+        throw std::runtime_error("Missing " + endTag + " in dlog file " +
+                                 this->filename);
+    }
+    this->data_begin_pos = lineEndPos == std::string::npos
+                               ? dlogXmlString.size()
+                               : lineEndPos + 1;
+    dlogXmlString.resize(endPos + endTag.size());
+
+    // HOTFIX: Make Invalid xml valid again ...
+    for (auto& tag : { std::string("1ua"), std::string("2ua") }) {
+        for (auto& fix :
+            { std::make_pair("<" + tag + ">", "<FIXME_" + tag + ">"),
+                std::make_pair("</" + tag + ">", "</FIXME_" + tag + ">") }) {
+            size_t pos = dlogXmlString.find(fix.first);
+            while (pos != std::string::npos) {
+                dlogXmlString.replace(pos, fix.first.size(), fix.second);
+                pos = dlogXmlString.find(fix.first, pos + fix.second.size());
+            }
         }
-        // HOTFIX: END!
-        dlogXmlString += line;
-    } while (line.find("</dlog>") == std::string::npos);
-    this->data_begin_pos = size_t(txtstream.tellg());
+    }
+    // HOTFIX: END!
 
     boost::property_tree::ptree dlog_xml;
-    boost::property_tree::read_xml(this->filename, dlog_xml);
+    std::istringstream dlogXmlStream(dlogXmlString);
+    boost::property_tree::read_xml(dlogXmlStream, dlog_xml);
 
     for (auto& c : dlog_xml.get_child("dlog")) {
         // Skip all non channel Elements
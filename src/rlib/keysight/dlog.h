@@ -35,6 +35,10 @@
 
 namespace rlib::keysight {
     class dlog {
+        private:
+        // Bytes read at once while searching for the end of the XML header
+        constexpr static size_t HEADER_CHUNK_SIZE = 4096;
+
         public:
         size_t data_begin_pos;
         std::string filename;
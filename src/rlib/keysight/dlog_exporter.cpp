@@ -22,6 +22,8 @@
  **/
 
 // Own
+#include "rlib/common/decode.h"
+#include "rlib/common/output_buffer.h"
 #include "rlib/keysight/dlog_exporter.h"
 
 // StdLib
@@ -29,8 +31,11 @@
 #include <cfloat>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <numeric>
+#include <sstream>
+#include <string_view>
 #include <vector>
 
 // Export data from begin (in seconds) till end (in seconds) to output stream
@@ -45,20 +50,30 @@ void rlib::keysight::dlog_exporter::data_export(
 void rlib::keysight::dlog_exporter::data_export(
     double begin, double end, int_fast32_t r, std::ostream& output)
 {
-    std::vector< rlib::common::sample > data;
-    if (r > 0) {
-        data = this->reader->samples(begin, end, r);
+    // The records are stored without time, the interval is taken from the
+    // resolution, the sensors or (if unknown) from the first two samples
+    double interval = r > 0 ? 1.0 / double(r) : -1.0;
+    auto sensors = this->reader->sensors();
+    for (auto& sensor : sensors) {
+        if (interval <= 0 && sensor.sampling_interval > 0) {
+            interval = sensor.sampling_interval;
+        }
     }
-    else {
-        data = this->reader->samples(begin, end);
+    if (interval <= 0) {
+        begin = std::fmax(begin, 0.0);
+        double head_end = begin + EXPORT_CHUNK_LENGTH;
+        auto head = this->reader->samples(
+            begin, end < 0 ? head_end : std::fmin(end, head_end));
+        interval = head.size() > 1 ? head[ 1 ].time - head[ 0 ].time : 1.0;
     }
 
-    output << "<!-- N6700X dlog settings -->" << std::endl;
-    output << "<dlog>" << std::endl;
+    std::ostringstream header;
+    header.precision(std::numeric_limits< double >::max_digits10);
+    header << "<!-- N6700X dlog settings -->" << '\n';
+    header << "<dlog>" << '\n';
 
     std::vector< std::map< std::string, size_t > > channels;
 
-    auto sensors = this->reader->sensors();
     for (size_t i = 0; i < sensors.size(); ++i) {
         if (sensors[ i ].unit != "A" && sensors[ i ].unit != "V") {
             std::cerr << "ERROR Unit " << sensors[ i ].unit
@@ -98,108 +113,124 @@ void rlib::keysight::dlog_exporter::data_export(
 
     int channelId = 1;
     for (auto channel : channels) {
-        output << "        <channel id=\"" << channelId << "\">" << std::endl;
-        output << "                <curr_trig_lev>0</curr_trig_lev>"
-               << std::endl;
-        output << "                <volt_trig_lev>0</volt_trig_lev>"
-               << std::endl;
-        output << "                <curr_trig_slope>0</curr_trig_slope>"
-               << std::endl;
-        output << "                <volt_trig_slope>0</volt_trig_slope>"
-               << std::endl;
-        output << "                <sense_volt>"
-               << (channel.count("V") > 0 ? 1 : 0) << "</sense_volt>"
-               << std::endl;
-        output << "                <sense_curr>"
-               << (channel.count("A") > 0 ? 1 : 0) << "</sense_curr>"
-               << std::endl;
-        output << "                <volt_range>0</volt_range>" << std::endl;
-        output << "                <curr_range>0</curr_range>" << std::endl;
-        output << "                <curr_auto_range>1</curr_auto_range>"
-               << std::endl;
-        output << "                <volt_auto_range>1</volt_auto_range>"
-               << std::endl;
-        output << "                <ident>" << std::endl;
-        output << "                        <model>N6785A</model>" << std::endl;
-        output << "                        <option>" << std::endl;
-        output << "                                <1ua>0</1ua>" << std::endl;
-        output << "                                <2ua>0</2ua>" << std::endl;
-        output << "                                <lga>0</lga>" << std::endl;
-        output << "                                <relay>0</relay>"
-               << std::endl;
-        output << "                                <reverse>0</reverse>"
-               << std::endl;
-        output << "                        </option>" << std::endl;
-        output << "                </ident>" << std::endl;
-        output << "        </channel>" << std::endl;
+        header << "        <channel id=\"" << channelId << "\">" << '\n';
+        header << "                <curr_trig_lev>0</curr_trig_lev>" << '\n';
+        header << "                <volt_trig_lev>0</volt_trig_lev>" << '\n';
+        header << "                <curr_trig_slope>0</curr_trig_slope>"
+               << '\n';
+        header << "                <volt_trig_slope>0</volt_trig_slope>"
+               << '\n';
+        header << "                <sense_volt>"
+               << (channel.count("V") > 0 ? 1 : 0) << "</sense_volt>" << '\n';
+        header << "                <sense_curr>"
+               << (channel.count("A") > 0 ? 1 : 0) << "</sense_curr>" << '\n';
+        header << "                <volt_range>0</volt_range>" << '\n';
+        header << "                <curr_range>0</curr_range>" << '\n';
+        header << "                <curr_auto_range>1</curr_auto_range>"
+               << '\n';
+        header << "                <volt_auto_range>1</volt_auto_range>"
+               << '\n';
+        header << "                <ident>" << '\n';
+        header << "                        <model>N6785A</model>" << '\n';
+        header << "                        <option>" << '\n';
+        header << "                                <1ua>0</1ua>" << '\n';
+        header << "                                <2ua>0</2ua>" << '\n';
+        header << "                                <lga>0</lga>" << '\n';
+        header << "                                <relay>0</relay>" << '\n';
+        header << "                                <reverse>0</reverse>"
+               << '\n';
+        header << "                        </option>" << '\n';
+        header << "                </ident>" << '\n';
+        header << "        </channel>" << '\n';
         ++channelId;
     }
 
-    output << "        <frame>" << std::endl;
-    output << "                <sense_minmax>0</sense_minmax>" << std::endl;
-    output << "                <trig_source>1</trig_source>" << std::endl;
-    output << "                <time>600</time>" << std::endl;
-    output << "                <offset>0</offset>" << std::endl;
-    output << "                <tint>" << double(1) / double(r) << "</tint>"
-           << std::endl;
-    output << "                <date>\"Wed Jan 25 17:47:22 2017\"</date>"
-           << std::endl;
-    output << "        </frame>" << std::endl;
+    header << "        <frame>" << '\n';
+    header << "                <sense_minmax>0</sense_minmax>" << '\n';
+    header << "                <trig_source>1</trig_source>" << '\n';
+    header << "                <time>600</time>" << '\n';
+    header << "                <offset>0</offset>" << '\n';
+    header << "                <tint>" << interval << "</tint>" << '\n';
+    header << "                <date>\"Wed Jan 25 17:47:22 2017\"</date>"
+           << '\n';
+    header << "        </frame>" << '\n';
 
     // This part more or less only contains meta data for the device
-    output << "        <gui_chan id=\"1\">" << std::endl;
-    output << "                <volt_trace>1</volt_trace>" << std::endl;
-    output << "                <curr_trace>1</curr_trace>" << std::endl;
-    output << "                <volt_gain>2</volt_gain>" << std::endl;
-    output << "                <volt_offset>0</volt_offset>" << std::endl;
-    output << "                <curr_gain>0.050000001</curr_gain>" << std::endl;
-    output << "                <curr_offset>0</curr_offset>" << std::endl;
-    output << "                <power_trace>0</power_trace>" << std::endl;
-    output << "                <power_gain>0.050000001</power_gain>"
-           << std::endl;
-    output << "                <power_offset>0</power_offset>" << std::endl;
-    output << "        </gui_chan>" << std::endl;
-    output << "        <gui_frame>" << std::endl;
-    output << "                <horiz_gain>5</horiz_gain>" << std::endl;
-    output << "                <horiz_offset>0</horiz_offset>" << std::endl;
-    output << "                <date_time>1</date_time>" << std::endl;
-    output << "                "
+    header << "        <gui_chan id=\"1\">" << '\n';
+    header << "                <volt_trace>1</volt_trace>" << '\n';
+    header << "                <curr_trace>1</curr_trace>" << '\n';
+    header << "                <volt_gain>2</volt_gain>" << '\n';
+    header << "                <volt_offset>0</volt_offset>" << '\n';
+    header << "                <curr_gain>0.050000001</curr_gain>" << '\n';
+    header << "                <curr_offset>0</curr_offset>" << '\n';
+    header << "                <power_trace>0</power_trace>" << '\n';
+    header << "                <power_gain>0.050000001</power_gain>" << '\n';
+    header << "                <power_offset>0</power_offset>" << '\n';
+    header << "        </gui_chan>" << '\n';
+    header << "        <gui_frame>" << '\n';
+    header << "                <horiz_gain>5</horiz_gain>" << '\n';
+    header << "                <horiz_offset>0</horiz_offset>" << '\n';
+    header << "                <date_time>1</date_time>" << '\n';
+    header << "                "
               "<base_filename>\"External:\\default.dlog\"</base_filename>"
-           << std::endl;
-    output << "                <marker1_pos>0.0000000</marker1_pos>"
-           << std::endl;
-    output << "                <marker2_pos>00.000000</marker2_pos>"
-           << std::endl;
-    output << "        </gui_frame>" << std::endl;
-    output << "</dlog>" << std::endl;
-
-    // 5 times Zero Bytes
-    output << uint8_t(0) << uint8_t(0) << uint8_t(0) << uint8_t(0)
-           << uint8_t(0);
+           << '\n';
+    header << "                <marker1_pos>0.0000000</marker1_pos>" << '\n';
+    header << "                <marker2_pos>00.000000</marker2_pos>" << '\n';
+    header << "        </gui_frame>" << '\n';
+    header << "</dlog>" << '\n';
 
-    // Values as 32 Bit floats
-    for (const auto& datum : data) {
-        for (size_t i = channels.size(); 0 < i; --i) {
-            if (channels[ i - 1 ].count("A") > 0) {
-                float value = float(datum.values.at(channels[ i - 1 ][ "A" ]));
-                // Little to Big Endian! (UNSAFE)
-                char* mem = reinterpret_cast< char* >(&value);
-                for (size_t j = 0; j < sizeof(value); ++j) {
-                    output << *mem;
-                    ++mem;
-                }
-            }
+    // Values as big endian 32 bit floats, the currents of all channels (last
+    // channel first) and then the voltages
+    std::vector< size_t > columns;
+    for (size_t i = channels.size(); 0 < i; --i) {
+        if (channels[ i - 1 ].count("A") > 0) {
+            columns.push_back(channels[ i - 1 ][ "A" ]);
         }
-        for (size_t i = channels.size(); 0 < i; --i) {
-            if (channels[ i - 1 ].count("V") > 0) {
-                float value = float(datum.values.at(channels[ i - 1 ][ "V" ]));
-                // Little to Big Endian! (UNSAFE)
-                char* mem = reinterpret_cast< char* >(&value);
-                for (size_t j = 0; j < sizeof(value); ++j) {
-                    output << *mem;
-                    ++mem;
+    }
+    for (size_t i = channels.size(); 0 < i; --i) {
+        if (channels[ i - 1 ].count("V") > 0) {
+            columns.push_back(channels[ i - 1 ][ "V" ]);
+        }
+    }
+
+    // The records are encoded in batches into the buffer and written in bulk,
+    // the samples are streamed from the reader in chunks
+    rlib::common::output_buffer buffer(output);
+    buffer.append(header.str());
+    // 5 times Zero Bytes (skipped by dlog_reader)
+    buffer.append(std::string_view("\0\0\0\0\0", 5));
+    if (columns.empty()) {
+        return;
+    }
+    const size_t batch_records =
+        std::max(size_t(1), ENCODE_BATCH_VALUES / columns.size());
+    std::vector< double > values;
+    auto consume = [&](const std::vector< rlib::common::sample >& data) {
+        for (size_t first = 0; first < data.size(); first += batch_records) {
+            const size_t count = std::min(batch_records, data.size() - first);
+            values.resize(count * columns.size());
+            for (size_t i = 0; i < count; ++i) {
+                const auto& datum = data[ first + i ].values;
+                for (size_t c = 0; c < columns.size(); ++c) {
+                    values[ i * columns.size() + c ] =
+                        columns[ c ] < datum.size()
+                            ? datum[ columns[ c ] ]
+                            : std::numeric_limits< double >::quiet_NaN();
                 }
             }
+            const size_t bytes = values.size() * sizeof(float);
+            rlib::common::encode_f32_be(
+                values.data(), values.size(), buffer.reserve(bytes));
+            buffer.commit(bytes);
         }
+    };
+    if (r > 0) {
+        consume(this->reader->samples(begin, end, r));
+    }
+    else {
+        this->reader->for_each_chunk(begin, end, EXPORT_CHUNK_LENGTH,
+            [&](size_t, std::vector< rlib::common::sample >& data) {
+                consume(data);
+            });
     }
 }
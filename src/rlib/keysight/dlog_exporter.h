@@ -27,11 +27,16 @@
 #include "rlib/common/exporter.h"
 
 // StdLib
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 
 namespace rlib::keysight {
     class dlog_exporter : public common::exporter {
+        private:
+        // Max. number of values encoded at once
+        constexpr static size_t ENCODE_BATCH_VALUES = size_t(1) << 16;
+
         public:
         using common::exporter::exporter;
 
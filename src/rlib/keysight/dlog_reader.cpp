@@ -23,18 +23,35 @@
 
 // Own
 #include "rlib/keysight/dlog_reader.h"
+#include "rlib/common/decode.h"
+#include "rlib/common/parallel.h"
 #include "rlib/keysight/dlog.h"
 
 // StdLib
 #include <algorithm>
 #include <cmath>
-#include <fstream>
+#include <cstddef>
 #include <iostream>
 #include <string>
+#include <vector>
 
 rlib::keysight::dlog_reader::dlog_reader(std::string filename)
     : _dlog(filename)
+    , _data(filename, common::mapped_file::access::SEQUENTIAL)
 {
+    // dlog_exporter writes zero bytes between the header and the records,
+    // they are skipped if the records only fit after them
+    size_t recordSize = this->sensors().size() * sizeof(float);
+    size_t pos = this->_dlog.data_begin_pos;
+    if (recordSize > 0 && this->_data.size() >= pos + PADDING_BYTES &&
+        (this->_data.size() - pos) % recordSize != 0 &&
+        (this->_data.size() - pos - PADDING_BYTES) % recordSize == 0) {
+        const char* padding = this->_data.data() + pos;
+        if (std::all_of(padding, padding + PADDING_BYTES,
+                [](char c) { return c == 0; })) {
+            this->_dlog.data_begin_pos += PADDING_BYTES;
+        }
+    }
 }
 
 std::string rlib::keysight::dlog_reader::filename()
@@ -95,39 +112,46 @@ std::vector< rlib::common::sample > rlib::keysight::dlog_reader::samples(
         return dataVector;
     }
     size_t valuesPerInterval = this->sensors().size();
-    size_t skipValues =
-        size_t(std::round(begin / this->_dlog.sampling_interval));
-    size_t begPos =
-        size_t(this->_dlog.data_begin_pos +
-               (valuesPerInterval * int(sizeof(float)) * skipValues));
-
-    std::ifstream dataStream(this->_dlog.filename, std::ios::binary);
-    {
-        dataStream.ignore(std::streamsize(begPos));
+    size_t recordSize = valuesPerInterval * sizeof(float);
+    size_t records = this->records();
+    size_t first = size_t(std::round(begin / this->_dlog.sampling_interval));
+    // Records till end (inclusive)
+    size_t last = std::min(records,
+        size_t(std::floor(end / this->_dlog.sampling_interval)) + 1);
+    while (last > first &&
+           double(last - 1) * this->_dlog.sampling_interval > end) {
+        --last;
     }
-    size_t pos = begPos;
-    while (dataStream.good()) {
-        rlib::common::sample datum;
-        // Calulate Time
-        datum.time = ((pos - begPos) / valuesPerInterval) *
-                     this->_dlog.sampling_interval;
-        if (datum.time > end) {
-            break;
-        }
-        // Add Values
-        for (size_t i = 0; i < valuesPerInterval; i++) {
-            // VALUE
-            // Read Values (As each value is a f32, float is used)
-            float value = -1;
-            dataStream.read(reinterpret_cast< char* >(&value), sizeof(value));
-            // Big to Little Endian! (UNSAFE)
-            char* mem = reinterpret_cast< char* >(&value);
-            std::reverse(mem, mem + sizeof(value));
-            datum.values.push_back(double(value));
-        }
-        dataVector.push_back(datum);
-        pos += valuesPerInterval * int(sizeof(float));
+    while (last < records &&
+           !(double(last) * this->_dlog.sampling_interval > end)) {
+        ++last;
+    }
+    if (first >= last) {
+        return dataVector;
     }
+
+    // Values are big endian f32, large ranges are decoded in parallel slices
+    // of records
+    const char* data =
+        this->_data.data() + this->_dlog.data_begin_pos + first * recordSize;
+    double interval = this->_dlog.sampling_interval;
+    dataVector.resize(last - first);
+    rlib::common::for_each_slice(last - first, PARALLEL_SLICE_RECORDS,
+        [&](size_t sliceFirst, size_t count) {
+            std::vector< double > values(count * valuesPerInterval);
+            rlib::common::decode_f32_be(data + sliceFirst * recordSize,
+                values.size(), values.data());
+            for (size_t i = 0; i < count; ++i) {
+                auto& datum = dataVector[ sliceFirst + i ];
+                // Calulate Time
+                datum.time = double(first + sliceFirst + i) * interval;
+                // Add Values
+                auto recordValues =
+                    values.begin() + std::ptrdiff_t(i * valuesPerInterval);
+                datum.values.assign(recordValues,
+                    recordValues + std::ptrdiff_t(valuesPerInterval));
+            }
+        });
     return dataVector;
 }
 
@@ -137,12 +161,16 @@ std::vector< rlib::common::event_data > rlib::keysight::dlog_reader::events(
     return {};
 }
 
+size_t rlib::keysight::dlog_reader::records()
+{
+    size_t recordSize = this->sensors().size() * sizeof(float);
+    if (recordSize == 0 || this->_data.size() < this->_dlog.data_begin_pos) {
+        return 0;
+    }
+    return (this->_data.size() - this->_dlog.data_begin_pos) / recordSize;
+}
+
 double rlib::keysight::dlog_reader::length()
 {
-    size_t valuesPerInterval = this->sensors().size();
-    std::ifstream data(
-        this->_dlog.filename, std::ifstream::ate | std::ifstream::binary);
-    size_t fileSize = size_t(data.tellg());
-    return double((fileSize - this->_dlog.data_begin_pos) / valuesPerInterval) *
-           this->_dlog.sampling_interval;
+    return double(this->records()) * this->_dlog.sampling_interval;
 }
@@ -25,6 +25,7 @@
 
 // Own
 #include "rlib/common/event_data.h"
+#include "rlib/common/mapped_file.h"
 #include "rlib/common/reader.h"
 #include "rlib/common/sample.h"
 #include "rlib/common/sensor.h"
@@ -37,7 +38,17 @@
 namespace rlib::keysight {
     class dlog_reader : public common::reader {
         private:
+        // Min. number of records decoded by one thread
+        constexpr static size_t PARALLEL_SLICE_RECORDS = 1 << 14;
+        // Zero bytes dlog_exporter writes after the header
+        constexpr static size_t PADDING_BYTES = 5;
+
         dlog _dlog;
+        common::mapped_file _data;
+
+        private:
+        // Number of complete sample records after the header
+        size_t records();
 
         public:
         dlog_reader(std::string filename);
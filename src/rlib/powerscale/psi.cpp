@@ -33,6 +33,7 @@
 
 // StdLib
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <limits>
 #include <stdexcept>
@@ -57,10 +58,14 @@ rlib::powerscale::psi::psi(std::string filename)
             "Invalid Checksum Value " + psi_checksum + " in " + filename);
     }
 
-    // Get SamplingRate (and transform it from kHz to Hz)
-    this->_sampling_rate = psi_xml.get< uint64_t >(
-                               "PSI.Measurement.SamplingRate.<xmlattr>.Value") *
-                           1000;
+    // Get SamplingRate (and transform it from kHz to Hz), rates below 1 kHz
+    // are fractions and rates need not be whole Hz
+    this->_sampling_rate =
+        psi_xml.get< double >("PSI.Measurement.SamplingRate.<xmlattr>.Value") *
+        1000;
+    if (!(this->_sampling_rate > 0.0)) {
+        throw std::runtime_error("Invalid SamplingRate in " + filename);
+    }
 
     // Get SamplingCount
     this->_sampling_count = psi_xml.get< uint64_t >(
@@ -128,14 +133,14 @@ uint32_t rlib::powerscale::psi::checksum()
     return this->_checksum;
 }
 
-uint64_t rlib::powerscale::psi::sampling_rate()
+double rlib::powerscale::psi::sampling_rate()
 {
     return this->_sampling_rate;
 }
 
 double rlib::powerscale::psi::update_rate()
 {
-    return double(1) / double(this->_sampling_rate);
+    return 1.0 / this->_sampling_rate;
 }
 
 uint64_t rlib::powerscale::psi::sampling_count()
@@ -38,7 +38,8 @@ namespace rlib::powerscale {
         std::string _filename;
         std::string _version;
         uint32_t _checksum;
-        uint64_t _sampling_rate;
+        // Sampling rate in Hz (not necessarily a whole number)
+        double _sampling_rate;
         uint64_t _sampling_count;
         std::vector< data_stream > _data_streams;
         std::vector< psd > _psds;
@@ -48,7 +49,7 @@ namespace rlib::powerscale {
         std::string filename();
         std::string version();
         uint32_t checksum();
-        uint64_t sampling_rate();
+        double sampling_rate();
         double update_rate();
         uint64_t sampling_count();
         std::vector< data_stream > data_streams();
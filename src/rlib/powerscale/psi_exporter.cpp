@@ -0,0 +1,395 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+// Own
+#include "rlib/powerscale/psi_exporter.h"
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Sensors (indices, -1 => none) of a data stream
+class stream_sensors {
+    public:
+    int64_t current = -1;
+    int64_t voltage = -1;
+    double min_current = std::numeric_limits< double >::quiet_NaN();
+    double max_current = std::numeric_limits< double >::quiet_NaN();
+    double min_voltage = std::numeric_limits< double >::quiet_NaN();
+    double max_voltage = std::numeric_limits< double >::quiet_NaN();
+};
+
+// Pairs the sensors into data streams of a current and a voltage. Sensors
+// with the unit A (V) take the current (voltage) of the open data stream,
+// sensors of other units take its first free slot.
+static std::vector< stream_sensors > pair_sensors(
+    const std::vector< rlib::common::sensor >& sensors)
+{
+    std::vector< stream_sensors > streams;
+    for (size_t i = 0; i < sensors.size(); ++i) {
+        bool freeCurrent = !streams.empty() && streams.back().current < 0;
+        bool freeVoltage = !streams.empty() && streams.back().voltage < 0;
+        bool current = sensors[ i ].unit == "A" ||
+                       (sensors[ i ].unit != "V" && !freeVoltage);
+        if (current ? !freeCurrent : !freeVoltage) {
+            streams.push_back(stream_sensors());
+        }
+        if (current) {
+            streams.back().current = int64_t(i);
+        }
+        else {
+            streams.back().voltage = int64_t(i);
+        }
+    }
+    return streams;
+}
+
+rlib::powerscale::psi_exporter::psi_exporter(
+    std::shared_ptr< rlib::common::reader > reader, std::string filename)
+    : rlib::common::exporter(reader)
+    , _filename(filename)
+{
+    if (this->_filename.size() < 4) {
+        throw std::runtime_error("Invalid psi filename " + this->_filename);
+    }
+}
+
+// Export data from begin (in seconds) till end (in seconds) to output stream
+void rlib::powerscale::psi_exporter::data_export(
+    double begin, double end, std::ostream& output)
+{
+    this->data_export(begin, end, -1, output);
+}
+
+// Export data from begin (in seconds) till end (in seconds) to output stream
+// with resolution r
+void rlib::powerscale::psi_exporter::data_export(
+    double begin, double end, int_fast32_t r, std::ostream& output)
+{
+    auto sensors = this->reader->sensors();
+    auto streams = pair_sensors(sensors);
+    const size_t valuesPerInterval = streams.size() * 2;
+    // Values (f64), an event word (u16) per data stream and the global event
+    const size_t sizePerValue = valuesPerInterval * sizeof(double) +
+                                streams.size() * sizeof(uint16_t) +
+                                sizeof(uint16_t);
+    const size_t psdRecords = std::max(size_t(1), PSD_FILE_SIZE / sizePerValue);
+
+    // Data stream of every sensor
+    std::vector< int64_t > sensorStream(sensors.size(), -1);
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (streams[ i ].current >= 0) {
+            sensorStream[ size_t(streams[ i ].current) ] = int64_t(i);
+        }
+        if (streams[ i ].voltage >= 0) {
+            sensorStream[ size_t(streams[ i ].voltage) ] = int64_t(i);
+        }
+    }
+
+    // Samples are stored without time, the interval is taken from the
+    // resolution, the sensors or (if unknown) from the first two samples
+    double interval = -1;
+    if (r > 0) {
+        interval = r <= 1 ? 1.0 : 1.0 / double(r);
+    }
+    for (auto& sensor : sensors) {
+        if (interval <= 0 && sensor.sampling_interval > 0) {
+            interval = sensor.sampling_interval;
+            break;
+        }
+    }
+    uint64_t nextSample = 0;
+    bool started = false;
+    // Input which a psi can not represent exactly
+    size_t roundedSamples = 0;
+    size_t roundedEvents = 0;
+    size_t mergedEvents = 0;
+    size_t movedEvents = 0;
+    auto events = this->reader->events(begin, end);
+    // Event words of a record with events
+    class record_events {
+        public:
+        std::vector< uint16_t > words;
+        size_t events = 0;
+    };
+    std::map< uint64_t, record_events > eventWords;
+    // Sample of time on the sampling grid, rounded is set if time is off the
+    // grid
+    auto toSample = [&interval](double time, bool& rounded) {
+        double position = std::fmax(time, 0.0) / interval;
+        double nearest = std::round(position);
+        rounded = std::fabs(position - nearest) > SAMPLE_TOLERANCE;
+        return uint64_t(nearest);
+    };
+
+    class psd_file {
+        public:
+        uint64_t first_sample;
+        size_t records;
+        size_t events;
+    };
+    std::vector< psd_file > psds;
+    std::ofstream psdStream;
+    std::vector< char > buffer;
+    auto psdFilename = [&](size_t id) {
+        return this->_filename.substr(0, this->_filename.size() - 4) + "_" +
+               std::to_string(id) + ".psd";
+    };
+    auto flush = [&]() {
+        psdStream.write(buffer.data(), std::streamsize(buffer.size()));
+        buffer.clear();
+        if (!psdStream.good()) {
+            throw std::runtime_error(
+                "Can not write " + psdFilename(psds.size() - 1));
+        }
+    };
+    auto close = [&]() {
+        flush();
+        psdStream.close();
+        if (psdStream.fail()) {
+            throw std::runtime_error(
+                "Can not write " + psdFilename(psds.size() - 1));
+        }
+    };
+
+    auto consume = [&](std::vector< rlib::common::sample >& data) {
+        if (data.empty()) {
+            return;
+        }
+        if (!started) {
+            if (interval <= 0) {
+                interval = data.size() > 1 ? data[ 1 ].time - data[ 0 ].time
+                                           : 1.0;
+            }
+            if (!(interval > 0)) {
+                throw std::runtime_error(
+                    "Invalid sampling interval for " + this->_filename);
+            }
+            for (auto& event : events) {
+                bool rounded;
+                auto& record = eventWords[ toSample(event.time, rounded) ];
+                roundedEvents += rounded ? 1 : 0;
+                record.words.resize(streams.size() + 1, 0);
+                // The origin is a sensor, its event is stored in the event
+                // word of its data stream and read back with the current of
+                // the stream (or as a global event)
+                size_t word = streams.size();
+                if (event.origin >= 0 &&
+                    size_t(event.origin) < sensorStream.size() &&
+                    sensorStream[ size_t(event.origin) ] >= 0) {
+                    word = size_t(sensorStream[ size_t(event.origin) ]);
+                }
+                bool current = word < streams.size() &&
+                               streams[ word ].current == event.origin;
+                movedEvents += event.origin >= 0 && !current ? 1 : 0;
+                uint16_t raw = 0;
+                std::memcpy(&raw, event.raw_data.data(),
+                    std::min(sizeof(raw), event.raw_data.size()));
+                mergedEvents += (record.words[ word ] & 0x80) != 0 ? 1 : 0;
+                record.words[ word ] |= uint16_t(raw | 0x80);
+                ++record.events;
+            }
+            started = true;
+        }
+
+        for (auto& datum : data) {
+            bool rounded;
+            uint64_t sample = toSample(datum.time, rounded);
+            roundedSamples += rounded ? 1 : 0;
+            if (!psds.empty() && sample < nextSample) {
+                throw std::runtime_error("Samples at " +
+                                         std::to_string(datum.time) +
+                                         " s overlap in " + this->_filename);
+            }
+            // Gaps in the samples start a new psd at the next sample, the
+            // psi keeps the offset of every psd
+            if (psds.empty() || psds.back().records >= psdRecords ||
+                sample != nextSample) {
+                if (psdStream.is_open()) {
+                    close();
+                }
+                psd_file psd;
+                {
+                    psd.first_sample = sample;
+                    psd.records = 0;
+                    psd.events = 0;
+                }
+                psds.push_back(psd);
+                psdStream.open(
+                    psdFilename(psds.size() - 1), std::ios::binary);
+                if (!psdStream.good()) {
+                    throw std::runtime_error(
+                        "Can not write " + psdFilename(psds.size() - 1));
+                }
+            }
+
+            size_t pos = buffer.size();
+            buffer.resize(pos + sizePerValue, 0);
+            char* record = buffer.data() + pos;
+            for (size_t i = 0; i < streams.size(); ++i) {
+                auto& stream = streams[ i ];
+                double current = std::numeric_limits< double >::quiet_NaN();
+                double voltage = std::numeric_limits< double >::quiet_NaN();
+                if (stream.current >= 0 &&
+                    size_t(stream.current) < datum.values.size()) {
+                    current = datum.values[ size_t(stream.current) ];
+                    stream.min_current = std::fmin(stream.min_current, current);
+                    stream.max_current = std::fmax(stream.max_current, current);
+                }
+                if (stream.voltage >= 0 &&
+                    size_t(stream.voltage) < datum.values.size()) {
+                    voltage = datum.values[ size_t(stream.voltage) ];
+                    stream.min_voltage = std::fmin(stream.min_voltage, voltage);
+                    stream.max_voltage = std::fmax(stream.max_voltage, voltage);
+                }
+                std::memcpy(
+                    record + 2 * i * sizeof(double), &current, sizeof(double));
+                std::memcpy(record + (2 * i + 1) * sizeof(double), &voltage,
+                    sizeof(double));
+            }
+            auto words = eventWords.find(sample);
+            if (words != eventWords.end()) {
+                std::memcpy(record + valuesPerInterval * sizeof(double),
+                    words->second.words.data(),
+                    words->second.words.size() * sizeof(uint16_t));
+                for (auto word : words->second.words) {
+                    psds.back().events += (word & 0x80) != 0 ? 1 : 0;
+                }
+                eventWords.erase(words);
+            }
+            ++psds.back().records;
+            nextSample = sample + 1;
+        }
+        flush();
+    };
+
+    if (r > 0) {
+        auto data = this->reader->samples(begin, end, r);
+        consume(data);
+    }
+    else {
+        this->reader->for_each_chunk(begin, end, EXPORT_CHUNK_LENGTH,
+            [&](size_t, std::vector< rlib::common::sample >& data) {
+                consume(data);
+            });
+    }
+    if (psdStream.is_open()) {
+        close();
+    }
+
+    // Events are stored in the record of their sample, events without a
+    // record are lost
+    size_t droppedEvents = 0;
+    for (auto& record : eventWords) {
+        droppedEvents += record.second.events;
+    }
+    if (roundedSamples > 0) {
+        std::cerr << "WARNING " << roundedSamples
+                  << " samples are not on the sampling grid of .psi, their "
+                     "times are rounded"
+                  << std::endl;
+    }
+    if (roundedEvents > 0) {
+        std::cerr << "WARNING " << roundedEvents
+                  << " events are not on the sampling grid of .psi, their "
+                     "times are rounded"
+                  << std::endl;
+    }
+    if (mergedEvents > 0) {
+        std::cerr << "WARNING " << mergedEvents
+                  << " events share the event word of another event in .psi"
+                  << std::endl;
+    }
+    if (movedEvents > 0) {
+        std::cerr << "WARNING " << movedEvents
+                  << " events of voltages or unknown sensors are stored with "
+                     "the current of their port or as global events in .psi"
+                  << std::endl;
+    }
+    if (droppedEvents > 0) {
+        std::cerr << "WARNING " << droppedEvents
+                  << " events are outside of the samples and are not "
+                     "supported in .psi"
+                  << std::endl;
+    }
+
+    // The psi indexes the psd files, counts are in values (of all sensors)
+    boost::property_tree::ptree psi_xml;
+    {
+        // The checksum is not verified by psi_reader
+        psi_xml.put("PSI.Checksum.<xmlattr>.Value", "0x0");
+        std::ostringstream samplingRate;
+        samplingRate.precision(17);
+        samplingRate << (interval > 0 ? 1.0 / interval / 1000.0 : 0.0);
+        psi_xml.put(
+            "PSI.Measurement.SamplingRate.<xmlattr>.Value", samplingRate.str());
+        psi_xml.put("PSI.Measurement.SamplingCount.<xmlattr>.Value",
+            nextSample * valuesPerInterval);
+        auto& dataStreams = psi_xml.put_child(
+            "PSI.DataStream", boost::property_tree::ptree());
+        for (size_t i = 0; i < streams.size(); ++i) {
+            boost::property_tree::ptree dstream;
+            {
+                dstream.put("<xmlattr>.Id", i);
+                dstream.put("<xmlattr>.ProbeID", i);
+                dstream.put("<xmlattr>.ProbeKind", 0);
+                dstream.put("<xmlattr>.voltageMin", streams[ i ].min_voltage);
+                dstream.put("<xmlattr>.voltageMax", streams[ i ].max_voltage);
+                dstream.put("<xmlattr>.currentMin", streams[ i ].min_current);
+                dstream.put("<xmlattr>.currentMax", streams[ i ].max_current);
+            }
+            dataStreams.add_child("DataStream", dstream);
+        }
+        auto& psdFiles =
+            psi_xml.put_child("PSI.PSD", boost::property_tree::ptree());
+        for (size_t i = 0; i < psds.size(); ++i) {
+            boost::property_tree::ptree psd;
+            {
+                psd.put("<xmlattr>.Id", i);
+                psd.put("<xmlattr>.Offset",
+                    psds[ i ].first_sample * valuesPerInterval);
+                psd.put("<xmlattr>.DataCount",
+                    psds[ i ].records * valuesPerInterval);
+                psd.put("<xmlattr>.EventCount", psds[ i ].events);
+            }
+            psdFiles.add_child("PSDFile", psd);
+        }
+    }
+    boost::property_tree::write_xml(output, psi_xml);
+    if (!output.good()) {
+        throw std::runtime_error("Can not write " + this->_filename);
+    }
+}
@@ -23,20 +23,32 @@
 
 // Own
 #include "rlib/powerscale/psi_reader.h"
+#include "rlib/common/decode.h"
+#include "rlib/common/parallel.h"
 #include "rlib/powerscale/psi.h"
 
 // StdLib
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
-#include <fstream>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 rlib::powerscale::psi_reader::psi_reader(std::string filename)
     : _psi(filename)
+    , _events_indexed(false)
 {
+    for (auto& psd : this->_psi.psds()) {
+        this->_psd_data.emplace_back(
+            psd.filename, rlib::common::mapped_file::access::SEQUENTIAL);
+    }
 }
 
 std::string rlib::powerscale::psi_reader::filename()
@@ -75,7 +87,14 @@ std::vector< rlib::common::sensor > rlib::powerscale::psi_reader::sensors()
     return sensors;
 }
 
-std::vector< rlib::common::sample > rlib::powerscale::psi_reader::samples(
+size_t rlib::powerscale::psi_reader::record_size()
+{
+    return this->sensors().size() * sizeof(double) +
+           this->_psi.data_streams().size() * sizeof(uint16_t) +
+           sizeof(uint16_t);
+}
+
+std::pair< uint64_t, uint64_t > rlib::powerscale::psi_reader::sample_range(
     double begin, double end)
 {
     if (begin < 0) {
@@ -85,173 +104,276 @@ std::vector< rlib::common::sample > rlib::powerscale::psi_reader::samples(
         end = this->length();
     }
     end = std::fmin(this->length(), end);
-    std::vector< rlib::common::sample > dataVector;
     if (begin >= end) {
-        return dataVector;
+        return { 0, 0 };
     }
 
-    size_t valuesPerInterval = this->sensors().size();
-    size_t sizePerValue = valuesPerInterval * 8 +
-                          this->_psi.data_streams().size() * 2 + 2; // in Byte
-    uint64_t begInMicroSeconds = uint64_t(begin * 1000 * 1000);
-    uint64_t endInMicroSeconds = uint64_t(end * 1000 * 1000);
-    uint64_t samplingRateInMicroSeconds =
-        uint64_t(this->_psi.update_rate() * 1000 * 1000);
-    uint64_t begSample = begInMicroSeconds / samplingRateInMicroSeconds;
-    uint64_t endSample = endInMicroSeconds / samplingRateInMicroSeconds;
-    std::vector< psd > affectedPSDs;
+    return { this->to_sample(begin), this->to_sample(end) };
+}
 
-    for (auto& psd : this->_psi.psds()) {
-        uint64_t psdMinSample = psd.offset / valuesPerInterval;
-        uint64_t psdMaxSample =
-            (psd.offset + psd.data_count) / valuesPerInterval;
-        if (!(psdMaxSample < begSample || psdMinSample > endSample)) {
-            affectedPSDs.push_back(psd);
-        }
+uint64_t rlib::powerscale::psi_reader::to_sample(double time)
+{
+    // Times computed as sample * interval land exactly on their sample even
+    // if the division rounds down (rates need not be whole Hz)
+    double sample = time * this->_psi.sampling_rate();
+    double nearest = std::round(sample);
+    if (std::fabs(sample - nearest) <= SAMPLE_TOLERANCE * nearest) {
+        return uint64_t(nearest);
     }
-    uint64_t curSample = begSample;
-    for (auto& psd : affectedPSDs) {
-        std::ifstream dataStream(psd.filename, std::ios::binary);
-        {
-            dataStream.ignore(
-                std::streamsize((curSample - psd.offset) * sizePerValue));
-        }
-        while (dataStream.good() && curSample < endSample) {
-            rlib::common::sample datum;
-            // Calulate Time
-            datum.time = double(curSample) * this->_psi.update_rate();
-            // Add Values
-            for (size_t i = 0; i < valuesPerInterval; i++) {
-                // Read Values (As each value is a f32, float is used)
-                double value = -1;
-                dataStream.read(
-                    reinterpret_cast< char* >(&value), sizeof(value));
-                datum.values.push_back(value);
-            }
+    return uint64_t(std::floor(sample));
+}
 
-            // Skip event data
-            for (size_t i = 0; i < this->_psi.data_streams().size(); i++) {
-                // Skip event data (each datastream can have an event of 2 Byte
-                // size)
-                dataStream.ignore(sizeof(uint16_t));
-            }
-            // Skip global event (2 Byte size)
-            dataStream.ignore(sizeof(uint16_t));
+void rlib::powerscale::psi_reader::for_each_segment(double begin, double end,
+    const std::function< void(uint64_t, const rlib::common::mapped_file&,
+        size_t, size_t) >& consumer)
+{
+    size_t valuesPerInterval = this->sensors().size();
+    size_t sizePerValue = this->record_size(); // in Byte
+    uint64_t begSample;
+    uint64_t endSample;
+    std::tie(begSample, endSample) = this->sample_range(begin, end);
 
-            dataVector.push_back(datum);
-            curSample++;
+    auto psds = this->_psi.psds();
+    uint64_t curSample = begSample;
+    for (size_t i = 0; i < psds.size() && curSample < endSample; ++i) {
+        // Offset counts values (of all sensors), not samples
+        uint64_t psdMinSample = psds[ i ].offset / valuesPerInterval;
+        auto& data = this->_psd_data[ i ];
+        uint64_t psdMaxSample = psdMinSample + data.size() / sizePerValue;
+        if (curSample >= psdMaxSample) {
+            continue;
+        }
+        curSample = std::max(curSample, psdMinSample);
+        uint64_t lastSample = std::min(endSample, psdMaxSample);
+        if (curSample < lastSample) {
+            consumer(curSample, data,
+                size_t(curSample - psdMinSample) * sizePerValue,
+                size_t(lastSample - curSample));
+            curSample = lastSample;
         }
     }
-    return dataVector;
 }
 
-std::vector< rlib::common::event_data > rlib::powerscale::psi_reader::events(
+std::vector< rlib::common::sample > rlib::powerscale::psi_reader::samples(
     double begin, double end)
 {
-    if (begin < 0) {
-        begin = 0;
-    }
-    if (end < 0) {
-        end = this->length();
-    }
-    end = std::fmin(this->length(), end);
-    std::vector< rlib::common::event_data > eventVector;
-    if (begin >= end) {
-        return eventVector;
-    }
+    // Segment of the range within one psd and its position in the output
+    class segment {
+        public:
+        uint64_t first_sample;
+        const rlib::common::mapped_file* data;
+        size_t pos;
+        size_t count;
+        size_t offset;
+    };
 
+    std::vector< rlib::common::sample > dataVector;
     size_t valuesPerInterval = this->sensors().size();
-    size_t sizePerValue = valuesPerInterval * 8 +
-                          this->_psi.data_streams().size() * 2 + 2; // in Byte
-    uint64_t begInMicroSeconds = uint64_t(begin * 1000 * 1000);
-    uint64_t endInMicroSeconds = uint64_t(end * 1000 * 1000);
-    uint64_t samplingRateInMicroSeconds =
-        uint64_t(this->_psi.update_rate() * 1000 * 1000);
-    uint64_t begSample = begInMicroSeconds / samplingRateInMicroSeconds;
-    uint64_t endSample = endInMicroSeconds / samplingRateInMicroSeconds;
-
-    std::vector< psd > affectedPSDs;
+    size_t sizePerValue = this->record_size();
+    double updateRate = this->_psi.update_rate();
+    std::vector< segment > segments;
+    size_t total = 0;
+    this->for_each_segment(begin, end,
+        [&](uint64_t curSample, const rlib::common::mapped_file& data,
+            size_t pos, size_t count) {
+            segment seg;
+            {
+                seg.first_sample = curSample;
+                seg.data = &data;
+                seg.pos = pos;
+                seg.count = count;
+                seg.offset = total;
+            }
+            // Every psd of the range starts reading ahead at once
+            data.advise(rlib::common::mapped_file::access::WILL_NEED, pos,
+                count * sizePerValue);
+            segments.push_back(seg);
+            total += count;
+        });
+    if (segments.empty()) {
+        return dataVector;
+    }
 
-    for (auto& psd : this->_psi.psds()) {
-        uint64_t psdMinSample = psd.offset / valuesPerInterval;
-        uint64_t psdMaxSample =
-            (psd.offset + psd.data_count) / valuesPerInterval;
-        if (!(psdMaxSample < begSample || psdMinSample > endSample)) {
-            affectedPSDs.push_back(psd);
-        }
+    // A sequential scan continues in the next psd once the range reaches the
+    // end of a psd, its head is prefetched while the range is decoded
+    const auto& last = segments.back();
+    size_t lastPsd = size_t(last.data - this->_psd_data.data());
+    if (last.pos + last.count * sizePerValue + sizePerValue >
+            last.data->size() &&
+        lastPsd + 1 < this->_psd_data.size()) {
+        this->_psd_data[ lastPsd + 1 ].advise(
+            rlib::common::mapped_file::access::WILL_NEED, 0, PREFETCH_BYTES);
     }
-    uint64_t curSample = begSample;
-    for (auto& psd : affectedPSDs) {
-        std::ifstream dataStream(psd.filename, std::ios::binary);
-        {
-            dataStream.ignore(
-                std::streamsize((curSample - psd.offset) * sizePerValue));
-        }
-        while (dataStream.good() && curSample < endSample) {
-            // Calulate Time
-            double curTime = double(curSample) * this->_psi.update_rate();
 
-            // Skip Values
-            for (uint64_t i = 0; i < valuesPerInterval; i++) {
-                // Skip Values (As each value is a f32)
-                dataStream.ignore(sizeof(uint32_t));
+    // The records of all segments are decoded in parallel slices, a slice
+    // may span several psds
+    dataVector.resize(total);
+    rlib::common::for_each_slice(total, PARALLEL_SLICE_RECORDS,
+        [&](size_t sliceFirst, size_t sliceCount) {
+            auto seg = std::upper_bound(segments.begin(), segments.end(),
+                sliceFirst, [](size_t item, const segment& s) {
+                    return item < s.offset;
+                });
+            --seg;
+            size_t sliceEnd = sliceFirst + sliceCount;
+            for (; seg != segments.end() && seg->offset < sliceEnd; ++seg) {
+                size_t first = std::max(sliceFirst, seg->offset) - seg->offset;
+                size_t count =
+                    std::min(sliceEnd, seg->offset + seg->count) - seg->offset -
+                    first;
+                // Values are f64 at the begin of every record (followed by
+                // the event data of the data streams and the global event),
+                // every sensor is decoded as one column
+                const char* records =
+                    seg->data->data() + seg->pos + first * sizePerValue;
+                std::vector< double > values(count * valuesPerInterval);
+                for (size_t i = 0; i < valuesPerInterval; i++) {
+                    rlib::common::decode_strided< double >(
+                        records + i * sizeof(double), count, sizePerValue,
+                        values.data() + i, valuesPerInterval);
+                }
+                for (size_t record = 0; record < count; ++record) {
+                    auto& datum = dataVector[ seg->offset + first + record ];
+                    // Calulate Time
+                    datum.time =
+                        double(seg->first_sample + first + record) *
+                        updateRate;
+                    // Add Values
+                    auto recordValues =
+                        values.begin() +
+                        std::ptrdiff_t(record * valuesPerInterval);
+                    datum.values.assign(recordValues,
+                        recordValues + std::ptrdiff_t(valuesPerInterval));
+                }
             }
+        });
+    return dataVector;
+}
 
-            // Read event data
-            for (uint64_t i = 0; i < this->_psi.data_streams().size(); i++) {
-                uint16_t rawValue;
-                dataStream.read(
-                    reinterpret_cast< char* >(&rawValue), sizeof(rawValue));
-                if ((rawValue & 0x80) != 0x0) {
-                    rlib::common::event_data eventData;
-                    {
-                        eventData.time = curTime;
-                        eventData.origin = int64_t(i);
+// Event of origin (-1 => global) with the raw event value at time
+static rlib::common::event_data psi_event(
+    double time, int64_t origin, uint16_t rawValue)
+{
+    rlib::common::event_data eventData;
+    {
+        eventData.time = time;
+        eventData.origin = origin;
 
-                        auto valuesBytes =
-                            reinterpret_cast< unsigned char* >(&rawValue);
-                        eventData.raw_data.push_back(*valuesBytes);
-                        eventData.raw_data.push_back(*(++valuesBytes));
+        auto valuesBytes = reinterpret_cast< unsigned char* >(&rawValue);
+        eventData.raw_data.push_back(*valuesBytes);
+        eventData.raw_data.push_back(*(++valuesBytes));
 
-                        std::stringstream hexValue;
-                        {
-                            for (auto x : eventData.raw_data) {
-                                hexValue << std::hex << x;
-                            }
-                        }
-                        eventData.message = hexValue.str();
-                    }
-                    eventVector.push_back(eventData);
-                }
+        std::stringstream hexValue;
+        {
+            for (auto x : eventData.raw_data) {
+                hexValue << std::hex << x;
             }
-            // Read global event (2 Byte size)
-            uint16_t rawValue;
-            dataStream.read(
-                reinterpret_cast< char* >(&rawValue), sizeof(rawValue));
-            if ((rawValue & 0x80) != 0x0) {
-                rlib::common::event_data eventData;
-                {
-                    eventData.time = curTime;
-                    eventData.origin = -1;
-
-                    auto valuesBytes =
-                        reinterpret_cast< unsigned char* >(&rawValue);
-                    eventData.raw_data.push_back(*valuesBytes);
-                    eventData.raw_data.push_back(*(++valuesBytes));
+        }
+        eventData.message = hexValue.str();
+    }
+    return eventData;
+}
 
-                    std::stringstream hexValue;
-                    {
-                        for (auto x : eventData.raw_data) {
-                            hexValue << std::hex << x;
+void rlib::powerscale::psi_reader::index_events()
+{
+    size_t valuesPerInterval = this->sensors().size();
+    size_t dataStreams = this->_psi.data_streams().size();
+    size_t sizePerValue = this->record_size();
+    // Event words of a record (every data stream and the global event)
+    size_t eventWords = dataStreams + 1;
+    auto psds = this->_psi.psds();
+    for (size_t i = 0; i < psds.size(); ++i) {
+        // The psi tells which psds have events at all
+        if (psds[ i ].event_count == 0) {
+            continue;
+        }
+        auto& data = this->_psd_data[ i ];
+        uint64_t psdMinSample = psds[ i ].offset / valuesPerInterval;
+        size_t records = data.size() / sizePerValue;
+        std::vector< std::vector< event_entry > > slices(
+            (records + PARALLEL_SLICE_RECORDS - 1) / PARALLEL_SLICE_RECORDS);
+        rlib::common::for_each_slice(records, PARALLEL_SLICE_RECORDS,
+            [&](size_t first, size_t count) {
+                auto& entries = slices[ first / PARALLEL_SLICE_RECORDS ];
+                for (size_t record = first; record < first + count;
+                     ++record) {
+                    const char* words = data.data() + record * sizePerValue +
+                                        valuesPerInterval * sizeof(double);
+                    // The occur bits of four words are tested at once, most
+                    // records have no event at all
+                    size_t word = 0;
+                    uint64_t occur = 0;
+                    for (; word + 4 <= eventWords; word += 4) {
+                        uint64_t chunk;
+                        std::memcpy(&chunk, words + word * sizeof(uint16_t),
+                            sizeof(chunk));
+                        occur |= chunk & OCCUR_MASK;
+                    }
+                    for (; word < eventWords; ++word) {
+                        uint16_t rawValue;
+                        std::memcpy(&rawValue,
+                            words + word * sizeof(uint16_t),
+                            sizeof(rawValue));
+                        occur |= rawValue & 0x80;
+                    }
+                    if (occur == 0) {
+                        continue;
+                    }
+                    for (word = 0; word < eventWords; ++word) {
+                        uint16_t rawValue;
+                        std::memcpy(&rawValue,
+                            words + word * sizeof(uint16_t),
+                            sizeof(rawValue));
+                        if ((rawValue & 0x80) == 0x0) {
+                            continue;
+                        }
+                        event_entry entry;
+                        {
+                            entry.sample = psdMinSample + record;
+                            // The events of a data stream belong to its
+                            // current sensor (see sensors())
+                            entry.origin =
+                                word < dataStreams ? int64_t(2 * word) : -1;
+                            entry.raw_value = rawValue;
                         }
+                        entries.push_back(entry);
                     }
-                    eventData.message = hexValue.str();
                 }
-                eventVector.push_back(eventData);
-            }
-            curSample++;
+            });
+        for (auto& entries : slices) {
+            this->_event_index.insert(
+                this->_event_index.end(), entries.begin(), entries.end());
         }
     }
+    // Psds are not required to be ordered
+    std::stable_sort(this->_event_index.begin(), this->_event_index.end(),
+        [](const event_entry& a, const event_entry& b) {
+            return a.sample < b.sample;
+        });
+    this->_events_indexed = true;
+}
+
+std::vector< rlib::common::event_data > rlib::powerscale::psi_reader::events(
+    double begin, double end)
+{
+    if (!this->_events_indexed) {
+        this->index_events();
+    }
+    std::vector< rlib::common::event_data > eventVector;
+    uint64_t begSample;
+    uint64_t endSample;
+    std::tie(begSample, endSample) = this->sample_range(begin, end);
+    auto first = std::lower_bound(this->_event_index.begin(),
+        this->_event_index.end(), begSample,
+        [](const event_entry& entry, uint64_t sample) {
+            return entry.sample < sample;
+        });
+    for (auto it = first;
+         it != this->_event_index.end() && it->sample < endSample; ++it) {
+        // Calulate Time
+        double curTime = double(it->sample) * this->_psi.update_rate();
+        eventVector.push_back(psi_event(curTime, it->origin, it->raw_value));
+    }
     return eventVector;
 }
 
@@ -24,19 +24,70 @@
 #pragma once
 
 // Own
+#include "rlib/common/mapped_file.h"
 #include "rlib/common/reader.h"
 #include "rlib/common/sample.h"
 #include "rlib/common/sensor.h"
 #include "rlib/powerscale/psi.h"
 
 // StdLib
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace rlib::powerscale {
     class psi_reader : public common::reader {
         private:
+        // Min. number of records decoded by one thread
+        constexpr static size_t PARALLEL_SLICE_RECORDS = 1 << 14;
+        // Bytes of the next psd prefetched when a range reaches the end of a
+        // psd
+        constexpr static size_t PREFETCH_BYTES = 16 << 20;
+        // Relative deviation of a time from a sample still taken as the time
+        // of the sample
+        constexpr static double SAMPLE_TOLERANCE = 1e-9;
+        // Occur bit (0x80) of four event words read at once
+        constexpr static uint64_t OCCUR_MASK = 0x0080008000800080;
+
+        // Event word of a data stream or the global event with the occur bit
+        // set
+        class event_entry {
+            public:
+            uint64_t sample;
+            // Index of the current sensor of the data stream (-1 => global)
+            int64_t origin;
+            uint16_t raw_value;
+        };
+
         psi _psi;
+        // Mapped data of every psd (same order as _psi.psds())
+        std::vector< common::mapped_file > _psd_data;
+        // Events of all psds ordered by sample, built on first use
+        std::vector< event_entry > _event_index;
+        bool _events_indexed;
+
+        private:
+        // Size of one sample record in a psd (values, events of every data
+        // stream and the global event) in bytes
+        size_t record_size();
+        // Index of the first sample and the sample after the last sample from
+        // begin (in seconds) till end (in seconds)
+        std::pair< uint64_t, uint64_t > sample_range(double begin, double end);
+        // Index of the sample at time (in seconds) or the sample before it
+        uint64_t to_sample(double time);
+        // Scans the event words of every psd with events once
+        void index_events();
+        // Passes the sample records from begin (in seconds) till end (in
+        // seconds) to consumer, one call per psd with the index of the first
+        // sample, the mapped psd, the offset of the first record within the
+        // psd and the number of records
+        void for_each_segment(double begin, double end,
+            const std::function< void(
+                uint64_t, const common::mapped_file&, size_t, size_t) >&
+                consumer);
 
         public:
         psi_reader(std::string filename);
@@ -48,6 +99,7 @@ namespace rlib::powerscale {
             double begin, double end) override final;
         virtual std::vector< common::event_data > events(
             double begin, double end) override final;
+        using common::reader::statistic;
         virtual std::vector< std::experimental::optional< double > > statistic(
             common::statistic_data t) override final;
         virtual double length() override final;
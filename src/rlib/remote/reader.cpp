@@ -26,6 +26,7 @@
 #include <boost/system/error_code.hpp>
 
 // Own
+#include "rlib/common/mapped_file.h"
 #include "rlib/remote/reader.h"
 
 // StdLib
@@ -39,11 +40,11 @@
 #include <utility>
 
 std::experimental::optional< rlib::common::sample > rlib::remote::reader::
-    read_from_buffer(char* buffer, size_t length)
+    read_from_buffer(const char* buffer, size_t length)
 {
     size_t bytes_read = 0;
     // Read remote_id
-    int64_t remote_id = *(reinterpret_cast< int64_t* >(buffer));
+    int64_t remote_id = *(reinterpret_cast< const int64_t* >(buffer));
     if (remote_id != this->remote_id()) {
         return {};
     }
@@ -51,12 +52,12 @@ std::experimental::optional< rlib::common::sample > rlib::remote::reader::
     bytes_read += sizeof(int64_t);
 
     // Read time in nanoseconds
-    int64_t time_in_ns = *(reinterpret_cast< int64_t* >(buffer));
+    int64_t time_in_ns = *(reinterpret_cast< const int64_t* >(buffer));
     buffer += sizeof(int64_t);
     bytes_read += sizeof(int64_t);
 
     // Read number of values
-    int64_t num_of_values = *(reinterpret_cast< int64_t* >(buffer));
+    int64_t num_of_values = *(reinterpret_cast< const int64_t* >(buffer));
     buffer += sizeof(int64_t);
     bytes_read += sizeof(int64_t);
 
@@ -65,7 +66,7 @@ std::experimental::optional< rlib::common::sample > rlib::remote::reader::
         sample.time = double(time_in_ns) / double(1000L * 1000L * 1000L);
     }
     while (bytes_read < length && num_of_values > 0) {
-        double value = *(reinterpret_cast< double* >(buffer));
+        double value = *(reinterpret_cast< const double* >(buffer));
         buffer += sizeof(double);
         bytes_read += sizeof(double);
         sample.values.push_back(value);
@@ -93,13 +94,12 @@ rlib::remote::reader::reader(std::string const& filename, size_t sensors,
           boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), m_port))
 {
     size_t buffer_length = (sizeof(int64_t) * 3) + (sizeof(double) * sensors);
-    char buffer[ buffer_length * 2 ];
     // Read Samples data
-    auto tellp = this->m_data.tellp();
-    this->m_data.seekg(std::ios_base::beg);
-    while (!this->m_data.eof()) {
-        this->m_data.read(buffer, std::streamsize(buffer_length));
-        auto sample = this->read_from_buffer(buffer, buffer_length);
+    rlib::common::mapped_file data(
+        filename, rlib::common::mapped_file::access::SEQUENTIAL);
+    for (size_t pos = 0; pos + buffer_length <= data.size();
+         pos += buffer_length) {
+        auto sample = this->read_from_buffer(data.data() + pos, buffer_length);
         if (sample && sample->values.size() == this->m_sensors) {
             this->m_samples.push_back(*sample);
             this->m_length = std::max(this->m_length, sample->time);
@@ -108,10 +108,6 @@ rlib::remote::reader::reader(std::string const& filename, size_t sensors,
     std::sort(this->m_samples.begin(), this->m_samples.end(),
         [](auto& a, auto& b) { return a.time < b.time; });
 
-    this->m_data.clear();
-    this->m_data.seekg(std::ios_base::end);
-    this->m_data.seekp(tellp);
-
     this->receive();
 
     this->m_io_service_thread =
@@ -141,20 +137,32 @@ std::vector< rlib::common::sample > rlib::remote::reader::samples(
     double begin, double end)
 {
     std::lock_guard< std::mutex > guard(this->m_samples_mutex);
-    auto first = std::find_if(this->m_samples.begin(), this->m_samples.end(),
-        [begin](auto& p) { return p.time >= begin; });
-    auto last = std::find_if(this->m_samples.begin(), this->m_samples.end(),
-        [end](auto& p) { return p.time > end; });
+    // Samples are ordered by time
+    auto first = std::lower_bound(this->m_samples.begin(),
+        this->m_samples.end(), begin,
+        [](auto& p, double time) { return p.time < time; });
+    auto last = std::upper_bound(first, this->m_samples.end(), end,
+        [](double time, auto& p) { return time < p.time; });
     return std::vector< rlib::common::sample >(first, last);
 }
+
 std::vector< rlib::common::event_data > rlib::remote::reader::events(
     double begin, double end)
 {
-    auto first = std::find_if(this->m_events.begin(), this->m_events.end(),
-        [begin](auto& p) { return p.time >= begin; });
-    auto last = std::find_if(this->m_events.begin(), this->m_events.end(),
-        [end](auto& p) { return p.time > end; });
-    return std::vector< rlib::common::event_data >(first, last);
+    return this->m_events.events(begin, end);
+}
+
+std::vector< rlib::common::event_data > rlib::remote::reader::
+    events_of_origin(double begin, double end, int64_t origin)
+{
+    return this->m_events.events_of_origin(begin, end, origin);
+}
+
+std::vector< rlib::common::event_data > rlib::remote::reader::
+    events_of_level(
+        double begin, double end, rlib::common::event_data_level level)
+{
+    return this->m_events.events_of_level(begin, end, level);
 }
 
 double rlib::remote::reader::length()
@@ -187,10 +195,14 @@ void rlib::remote::reader::receive()
                                         sizeof(double) * this->m_sensors));
                     this->m_data.flush();
                     std::lock_guard< std::mutex > guard(this->m_samples_mutex);
-                    this->m_samples.push_back(*sample);
-                    this->m_length = std::max(this->m_length, sample->time);
-                    std::sort(this->m_samples.begin(), this->m_samples.end(),
-                        [](auto& a, auto& b) { return a.time < b.time; });
+                    // Keep the samples ordered by time, usually the sample is
+                    // the latest one and appended
+                    auto pos = std::upper_bound(this->m_samples.begin(),
+                        this->m_samples.end(), sample->time,
+                        [](double time, auto& p) { return time < p.time; });
+                    this->m_samples.insert(pos, std::move(*sample));
+                    this->m_length =
+                        std::max(this->m_length, this->m_samples.back().time);
                 }
             }
             this->receive();
@@ -29,6 +29,7 @@
 
 // Own
 #include "rlib/common/event_data.h"
+#include "rlib/common/event_store.h"
 #include "rlib/common/reader.h"
 #include "rlib/common/sample.h"
 #include "rlib/common/sensor.h"
@@ -61,7 +62,7 @@ namespace rlib {
 
             std::vector< rlib::common::sample > m_samples;
             std::mutex m_samples_mutex;
-            std::vector< rlib::common::event_data > m_events;
+            rlib::common::event_store m_events;
 
             boost::asio::io_service m_io_service;
             boost::asio::ip::udp::socket m_socket;
@@ -70,7 +71,7 @@ namespace rlib {
 
             private:
             std::experimental::optional< rlib::common::sample >
-                read_from_buffer(char* buffer, size_t length);
+                read_from_buffer(const char* buffer, size_t length);
 
             public:
             reader(std::string const& filename, size_t sensors, uint16_t port,
@@ -84,6 +85,11 @@ namespace rlib {
                 double begin, double end) override final;
             virtual std::vector< rlib::common::event_data > events(
                 double begin, double end) override final;
+            virtual std::vector< rlib::common::event_data > events_of_origin(
+                double begin, double end, int64_t origin) override final;
+            virtual std::vector< rlib::common::event_data > events_of_level(
+                double begin, double end,
+                rlib::common::event_data_level level) override final;
             virtual double length() override final;
 
             uint16_t port();
@@ -22,19 +22,77 @@
  **/
 
 // Own
+#include "rlib/common/output_buffer.h"
 #include "rlib/xml/xml_exporter.h"
 
 // StdLib
 #include <algorithm>
-#include <cfloat>
 #include <cmath>
-#include <iomanip>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <limits>
-#include <map>
-#include <numeric>
+#include <memory>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+// Appends text with the characters which are markup in xml replaced by
+// references
+static void append_escaped(
+    rlib::common::output_buffer& buffer, std::string_view text)
+{
+    size_t pos = 0;
+    while (pos < text.size()) {
+        auto markup = text.find_first_of("&<>\"'", pos);
+        buffer.append(text.substr(pos, markup - pos));
+        if (markup == std::string_view::npos) {
+            break;
+        }
+        switch (text[ markup ]) {
+            case '&':
+                buffer.append("&amp;");
+                break;
+            case '<':
+                buffer.append("&lt;");
+                break;
+            case '>':
+                buffer.append("&gt;");
+                break;
+            case '"':
+                buffer.append("&quot;");
+                break;
+            default:
+                buffer.append("&apos;");
+                break;
+        }
+        pos = markup + 1;
+    }
+}
+
+// Appends the bytes as hex digits, high nibble first
+static void append_hex(rlib::common::output_buffer& buffer,
+    const std::vector< unsigned char >& bytes)
+{
+    constexpr size_t BATCH_BYTES = 4096;
+    const char* digits = "0123456789ABCDEF";
+    for (size_t first = 0; first < bytes.size(); first += BATCH_BYTES) {
+        const size_t count = std::min(BATCH_BYTES, bytes.size() - first);
+        char* hex = buffer.reserve(2 * count);
+        for (size_t i = 0; i < count; ++i) {
+            hex[ 2 * i ] = digits[ bytes[ first + i ] >> 4 ];
+            hex[ 2 * i + 1 ] = digits[ bytes[ first + i ] & 15 ];
+        }
+        buffer.commit(2 * count);
+    }
+}
+
+rlib::xml::xml_exporter::xml_exporter(
+    std::shared_ptr< common::reader > reader, bool compact)
+    : common::exporter(std::move(reader))
+    , _compact(compact)
+{
+}
+
 void rlib::xml::xml_exporter::data_export(
     double begin, double end, std::ostream& output)
 {
@@ -44,62 +102,109 @@ void rlib::xml::xml_exporter::data_export(
 void rlib::xml::xml_exporter::data_export(
     double begin, double end, int_fast32_t r, std::ostream& output)
 {
-    output << std::setprecision(
-        std::numeric_limits< long double >::digits10 + 1);
-    std::vector< rlib::common::event_data > events =
-        this->reader->events(begin, end);
-    std::vector< rlib::common::sample > data;
-    if (r > 0) {
-        data = this->reader->samples(begin, end, r);
-    }
-    else {
-        data = this->reader->samples(begin, end);
+    // Elements are formatted into the buffer and written in bulk. Samples
+    // are streamed from the reader in chunks, events are read as one range
+    // (readers differ in whether a range includes its end, so events on
+    // chunk borders could not be told apart from duplicates)
+    rlib::common::output_buffer buffer(output);
+    // Starts a line of an element at depth
+    auto line = [&](size_t depth) {
+        if (!this->_compact) {
+            buffer.append('\n');
+            for (size_t i = 0; i < depth; ++i) {
+                buffer.append("    ");
+            }
+        }
+    };
+    auto sensors = this->reader->sensors();
+    begin = std::fmax(begin, 0.0);
+    const bool open_end = end < 0;
+    if (open_end) {
+        end = this->reader->length();
     }
 
-    auto sensors = this->reader->sensors();
-    output << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
-    output << "<output from=\"" << this->reader->filename() << "\">"
-           << std::endl;
+    buffer.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+    line(0);
+    buffer.append("<output from=\"");
+    append_escaped(buffer, this->reader->filename());
+    buffer.append("\">");
     // Sensors
-    output << "    <sensors>" << std::endl;
+    line(1);
+    buffer.append("<sensors>");
     for (size_t i = 0; i < sensors.size(); ++i) {
-        output << "        <sensor id=\"" << i << "\" name=\""
-               << sensors.at(i).name << "\" unit=\"" << sensors.at(i).unit
-               << "\" />" << std::endl;
+        line(2);
+        buffer.append("<sensor id=\"");
+        buffer.append_integer(int64_t(i));
+        buffer.append("\" name=\"");
+        append_escaped(buffer, sensors[ i ].name);
+        buffer.append("\" unit=\"");
+        append_escaped(buffer, sensors[ i ].unit);
+        buffer.append("\" />");
     }
-    output << "    </sensors>" << std::endl;
+    line(1);
+    buffer.append("</sensors>");
 
     // Data
-    output << "    <dataset>" << std::endl;
-    for (const auto& datum : data) {
-        output << "         <data time=\"" << datum.time << "\">" << std::endl;
-        for (size_t i = 0; i < datum.values.size(); ++i) {
-            output << "            <value sensor=\"" << i << "\" value=\""
-                   << datum.values.at(i) << "\"";
-            output << " />" << std::endl;
+    line(1);
+    buffer.append("<dataset>");
+    auto consume = [&](const std::vector< rlib::common::sample >& data) {
+        for (const auto& datum : data) {
+            line(2);
+            buffer.append("<data time=\"");
+            buffer.append_double(datum.time);
+            buffer.append("\">");
+            for (size_t i = 0; i < datum.values.size(); ++i) {
+                line(3);
+                buffer.append("<value sensor=\"");
+                buffer.append_integer(int64_t(i));
+                buffer.append("\" value=\"");
+                buffer.append_double(datum.values[ i ]);
+                buffer.append("\" />");
+            }
+            line(2);
+            buffer.append("</data>");
         }
-        output << "</data>" << std::endl;
+    };
+    if (r > 0) {
+        consume(this->reader->samples(begin, end, r));
+    }
+    else {
+        this->reader->for_each_chunk(begin, end, EXPORT_CHUNK_LENGTH,
+            [&](size_t, std::vector< rlib::common::sample >& data) {
+                consume(data);
+            });
     }
-    output << "    </dataset>" << std::endl;
+    line(1);
+    buffer.append("</dataset>");
 
     // Events
-    output << "    <events>" << std::endl;
-    for (const auto& event : events) {
-        output << "        <event level=\"" << event.event_level << "\" time=\""
-               << event.time << "\" origin=\"" << event.origin << "\" >"
-               << std::endl;
-        output << "            <message>" << event.message << "</message>"
-               << std::endl;
-        output << "            <data>";
-        for (auto c : event.raw_data) {
-            for (size_t i = 0; i < sizeof(c) * 2; ++i) {
-                output << "0123456789ABCDEF"[ c & 15 ];
-                c = c >> 4;
-            }
-        }
-        output << "</data>";
-        output << "        </event>";
+    line(1);
+    buffer.append("<events>");
+    // An open end includes the events after the last sample
+    for (const auto& event :
+        this->reader->events(begin, open_end ? -1.0 : end)) {
+        line(2);
+        buffer.append("<event level=\"");
+        buffer.append_integer(int64_t(event.event_level));
+        buffer.append("\" time=\"");
+        buffer.append_double(event.time);
+        buffer.append("\" origin=\"");
+        buffer.append_integer(event.origin);
+        buffer.append("\">");
+        line(3);
+        buffer.append("<message>");
+        append_escaped(buffer, event.message);
+        buffer.append("</message>");
+        line(3);
+        buffer.append("<data>");
+        append_hex(buffer, event.raw_data);
+        buffer.append("</data>");
+        line(2);
+        buffer.append("</event>");
     }
-    output << "   </events>" << std::endl;
-    output << "</output>" << std::endl;
+    line(1);
+    buffer.append("</events>");
+    line(0);
+    buffer.append("</output>");
+    buffer.append('\n');
 }
@@ -27,12 +27,19 @@
 #include "rlib/common/exporter.h"
 
 // StdLib
+#include <cstdint>
 #include <iostream>
+#include <memory>
 
 namespace rlib::xml {
     class xml_exporter : public common::exporter {
+        private:
+        bool _compact = false;
+
         public:
         using common::exporter::exporter;
+        // A compact document has no indentation and no line breaks
+        xml_exporter(std::shared_ptr< common::reader > reader, bool compact);
 
         virtual void data_export(double begin, double end,
             std::ostream& output = std::cout) override final;
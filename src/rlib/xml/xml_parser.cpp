@@ -0,0 +1,340 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Own
+#include "rlib/xml/xml_parser.h"
+
+// StdLib
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+static bool is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static std::string_view trim(std::string_view raw)
+{
+    while (!raw.empty() && is_blank(raw.front())) {
+        raw.remove_prefix(1);
+    }
+    while (!raw.empty() && is_blank(raw.back())) {
+        raw.remove_suffix(1);
+    }
+    return raw;
+}
+
+// Position of the first occurrence of token in [begin, end) (end if there is
+// none)
+static const char* find(const char* begin, const char* end, const char* token)
+{
+    const size_t length = std::strlen(token);
+    while (size_t(end - begin) >= length) {
+        auto found = static_cast< const char* >(
+            std::memchr(begin, token[ 0 ], size_t(end - begin) - length + 1));
+        if (found == nullptr) {
+            break;
+        }
+        if (std::memcmp(found, token, length) == 0) {
+            return found;
+        }
+        begin = found + 1;
+    }
+    return end;
+}
+
+static bool starts_with(const char* begin, const char* end, const char* token)
+{
+    const size_t length = std::strlen(token);
+    return size_t(end - begin) >= length &&
+           std::memcmp(begin, token, length) == 0;
+}
+
+rlib::xml::xml_pull_parser::xml_pull_parser(const char* begin, const char* end)
+    : _pos(begin)
+    , _end(end)
+{
+}
+
+rlib::xml::xml_pull_parser::node rlib::xml::xml_pull_parser::next()
+{
+    if (this->_pending_end) {
+        this->_pending_end = false;
+        return node::END;
+    }
+    while (this->_pos < this->_end) {
+        if (*this->_pos != '<') {
+            auto text_end = static_cast< const char* >(std::memchr(
+                this->_pos, '<', size_t(this->_end - this->_pos)));
+            if (text_end == nullptr) {
+                text_end = this->_end;
+            }
+            this->_text = std::string_view(
+                this->_pos, size_t(text_end - this->_pos));
+            this->_cdata = false;
+            this->_pos = text_end;
+            return node::TEXT;
+        }
+        if (starts_with(this->_pos, this->_end, "<!--")) {
+            auto comment_end = find(this->_pos + 4, this->_end, "-->");
+            if (comment_end == this->_end) {
+                throw std::runtime_error("Unterminated xml comment");
+            }
+            this->_pos = comment_end + 3;
+            continue;
+        }
+        if (starts_with(this->_pos, this->_end, "<![CDATA[")) {
+            auto cdata_end = find(this->_pos + 9, this->_end, "]]>");
+            if (cdata_end == this->_end) {
+                throw std::runtime_error("Unterminated xml cdata section");
+            }
+            this->_text = std::string_view(
+                this->_pos + 9, size_t(cdata_end - this->_pos - 9));
+            this->_cdata = true;
+            this->_pos = cdata_end + 3;
+            return node::TEXT;
+        }
+        if (starts_with(this->_pos, this->_end, "<?")) {
+            auto instruction_end = find(this->_pos + 2, this->_end, "?>");
+            if (instruction_end == this->_end) {
+                throw std::runtime_error("Unterminated xml instruction");
+            }
+            this->_pos = instruction_end + 2;
+            continue;
+        }
+        if (starts_with(this->_pos, this->_end, "<!")) {
+            auto declaration_end = static_cast< const char* >(std::memchr(
+                this->_pos, '>', size_t(this->_end - this->_pos)));
+            if (declaration_end == nullptr) {
+                throw std::runtime_error("Unterminated xml declaration");
+            }
+            this->_pos = declaration_end + 1;
+            continue;
+        }
+
+        // Start or end tag, a '>' may be part of a quoted attribute value
+        const bool end_tag = starts_with(this->_pos, this->_end, "</");
+        const char* name_begin = this->_pos + (end_tag ? 2 : 1);
+        const char* tag_end = name_begin;
+        for (char quote = 0; tag_end != this->_end; ++tag_end) {
+            if (quote != 0) {
+                if (*tag_end == quote) {
+                    quote = 0;
+                }
+            }
+            else if (*tag_end == '"' || *tag_end == '\'') {
+                quote = *tag_end;
+            }
+            else if (*tag_end == '>') {
+                break;
+            }
+        }
+        if (tag_end == this->_end) {
+            throw std::runtime_error("Unterminated xml tag");
+        }
+        const char* name_end = name_begin;
+        while (name_end != tag_end && !is_blank(*name_end) &&
+               *name_end != '/') {
+            ++name_end;
+        }
+        this->_name =
+            std::string_view(name_begin, size_t(name_end - name_begin));
+        this->_pos = tag_end + 1;
+        if (end_tag) {
+            return node::END;
+        }
+        const char* attributes_end = tag_end;
+        if (attributes_end != name_end && *(attributes_end - 1) == '/') {
+            --attributes_end;
+            this->_pending_end = true;
+        }
+        this->_attributes =
+            std::string_view(name_end, size_t(attributes_end - name_end));
+        return node::START;
+    }
+    return node::DONE;
+}
+
+std::string_view rlib::xml::xml_pull_parser::name() const
+{
+    return this->_name;
+}
+
+bool rlib::xml::xml_pull_parser::attribute(
+    std::string_view name, std::string_view& value) const
+{
+    const char* pos = this->_attributes.data();
+    const char* end = pos + this->_attributes.size();
+    while (pos != end) {
+        while (pos != end && is_blank(*pos)) {
+            ++pos;
+        }
+        const char* name_begin = pos;
+        while (pos != end && *pos != '=' && !is_blank(*pos)) {
+            ++pos;
+        }
+        std::string_view attribute_name(
+            name_begin, size_t(pos - name_begin));
+        while (pos != end && (is_blank(*pos) || *pos == '=')) {
+            ++pos;
+        }
+        if (pos == end || (*pos != '"' && *pos != '\'')) {
+            return false;
+        }
+        const char quote = *pos++;
+        const char* value_begin = pos;
+        while (pos != end && *pos != quote) {
+            ++pos;
+        }
+        if (attribute_name == name) {
+            value = std::string_view(value_begin, size_t(pos - value_begin));
+            return true;
+        }
+        if (pos != end) {
+            ++pos;
+        }
+    }
+    return false;
+}
+
+std::string rlib::xml::xml_pull_parser::text() const
+{
+    if (this->_cdata) {
+        return std::string(this->_text);
+    }
+    return rlib::xml::decode_entities(this->_text);
+}
+
+const char* rlib::xml::xml_pull_parser::position() const
+{
+    return this->_pos;
+}
+
+// Appends the code point as utf-8
+static void append_utf8(std::string& text, uint32_t code_point)
+{
+    if (code_point < 0x80) {
+        text.push_back(char(code_point));
+    }
+    else if (code_point < 0x800) {
+        text.push_back(char(0xC0 | (code_point >> 6)));
+        text.push_back(char(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000) {
+        text.push_back(char(0xE0 | (code_point >> 12)));
+        text.push_back(char(0x80 | ((code_point >> 6) & 0x3F)));
+        text.push_back(char(0x80 | (code_point & 0x3F)));
+    }
+    else {
+        text.push_back(char(0xF0 | (code_point >> 18)));
+        text.push_back(char(0x80 | ((code_point >> 12) & 0x3F)));
+        text.push_back(char(0x80 | ((code_point >> 6) & 0x3F)));
+        text.push_back(char(0x80 | (code_point & 0x3F)));
+    }
+}
+
+std::string rlib::xml::decode_entities(std::string_view raw)
+{
+    std::string text;
+    text.reserve(raw.size());
+    size_t pos = 0;
+    while (pos < raw.size()) {
+        auto amp = raw.find('&', pos);
+        auto semicolon = amp == raw.npos ? raw.npos : raw.find(';', amp);
+        if (semicolon == raw.npos) {
+            text.append(raw.substr(pos));
+            break;
+        }
+        text.append(raw.substr(pos, amp - pos));
+        auto entity = raw.substr(amp + 1, semicolon - amp - 1);
+        uint32_t code_point = 0;
+        bool known = true;
+        if (entity == "lt") {
+            code_point = '<';
+        }
+        else if (entity == "gt") {
+            code_point = '>';
+        }
+        else if (entity == "amp") {
+            code_point = '&';
+        }
+        else if (entity == "quot") {
+            code_point = '"';
+        }
+        else if (entity == "apos") {
+            code_point = '\'';
+        }
+        else if (entity.size() > 1 && entity[ 0 ] == '#') {
+            const bool hex = entity[ 1 ] == 'x' || entity[ 1 ] == 'X';
+            auto digits = entity.substr(hex ? 2 : 1);
+            auto result = std::from_chars(digits.data(),
+                digits.data() + digits.size(), code_point, hex ? 16 : 10);
+            known = result.ec == std::errc() &&
+                    result.ptr == digits.data() + digits.size() &&
+                    code_point != 0 && code_point <= 0x10FFFF &&
+                    (code_point < 0xD800 || code_point > 0xDFFF);
+        }
+        else {
+            known = false;
+        }
+        if (known) {
+            append_utf8(text, code_point);
+        }
+        else {
+            // Unknown references are kept as they are
+            text.append(raw.substr(amp, semicolon - amp + 1));
+        }
+        pos = semicolon + 1;
+    }
+    return text;
+}
+
+double rlib::xml::parse_double(std::string_view raw, double fallback)
+{
+    raw = trim(raw);
+    // from_chars does not accept a leading plus
+    if (!raw.empty() && raw.front() == '+') {
+        raw.remove_prefix(1);
+    }
+    double value;
+    auto result = std::from_chars(raw.data(), raw.data() + raw.size(), value);
+    if (result.ec != std::errc() || result.ptr != raw.data() + raw.size()) {
+        return fallback;
+    }
+    return value;
+}
+
+int64_t rlib::xml::parse_int(std::string_view raw, int64_t fallback)
+{
+    raw = trim(raw);
+    if (!raw.empty() && raw.front() == '+') {
+        raw.remove_prefix(1);
+    }
+    int64_t value;
+    auto result = std::from_chars(raw.data(), raw.data() + raw.size(), value);
+    if (result.ec != std::errc() || result.ptr != raw.data() + raw.size()) {
+        return fallback;
+    }
+    return value;
+}
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+
+// Own
+
+// StdLib
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace rlib::xml {
+    // Pull parser working directly on the (mapped) bytes of a xml document.
+    // No tree of the document is built, next() returns one node after the
+    // other and names and attributes point into the document. Comments,
+    // processing instructions and doctypes are skipped.
+    class xml_pull_parser {
+        public:
+        enum class node { START, END, TEXT, DONE };
+
+        private:
+        const char* _pos;
+        const char* _end;
+        std::string_view _name;
+        // Attribute bytes of the last start tag
+        std::string_view _attributes;
+        std::string_view _text;
+        bool _cdata = false;
+        // An empty element (<a />) returns START and then END
+        bool _pending_end = false;
+
+        public:
+        xml_pull_parser(const char* begin, const char* end);
+
+        node next();
+        // Name of the element of the last START or END
+        std::string_view name() const;
+        // Undecoded value of the attribute of the last START, false if the
+        // element has no such attribute
+        bool attribute(std::string_view name, std::string_view& value) const;
+        // Decoded text of the last TEXT
+        std::string text() const;
+        // Start of the part of the document not parsed yet
+        const char* position() const;
+    };
+
+    // Replaces the predefined and the numeric character references of raw,
+    // unknown and invalid references are kept as they are
+    std::string decode_entities(std::string_view raw);
+
+    // Value of the number in raw (blanks around it are ignored), fallback if
+    // raw is no number
+    double parse_double(std::string_view raw, double fallback);
+    int64_t parse_int(std::string_view raw, int64_t fallback);
+}
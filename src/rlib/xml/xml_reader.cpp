@@ -21,107 +21,251 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **/
 
-// Ext
-#include <boost/lexical_cast.hpp>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/xml_parser.hpp>
-
 // Own
+#include "rlib/common/mapped_file.h"
 #include "rlib/common/reader.h"
 #include "rlib/common/sample.h"
 #include "rlib/common/sensor.h"
+#include "rlib/xml/xml_parser.h"
 #include "rlib/xml/xml_reader.h"
 
 // StdLib
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
-#include <iostream>
+#include <initializer_list>
 #include <limits>
-#include <map>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
 #include <string>
-#include <tuple>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+// Value of the hex digit c (upper or lower case), 0 if c is no hex digit
+static unsigned char hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return static_cast< unsigned char >(c - '0');
+    }
+    if (c >= 'A' && c <= 'F') {
+        return static_cast< unsigned char >(c - 'A' + 10);
+    }
+    if (c >= 'a' && c <= 'f') {
+        return static_cast< unsigned char >(c - 'a' + 10);
+    }
+    return 0;
+}
+
 rlib::xml::xml_reader::xml_reader(std::string filename)
 {
     this->_filename = filename;
 
-    boost::property_tree::ptree xml;
-    boost::property_tree::read_xml(this->_filename, xml);
+    auto sensor_loaded = std::make_shared< std::promise< void > >();
+    this->_async_loader_sensor = sensor_loaded->get_future().share();
+    this->_async_loader =
+        std::async(std::launch::async, [this, sensor_loaded]() {
+            try {
+                this->load(*sensor_loaded);
+            }
+            catch (...) {
+                // Callers waiting for the sensors or rows get the error
+                // instead of waiting forever
+                {
+                    std::lock_guard< std::mutex > lock(this->_loader_mutex);
+                    this->_loader_error = std::current_exception();
+                }
+                try {
+                    sensor_loaded->set_exception(std::current_exception());
+                }
+                catch (std::future_error&) {
+                    // The sensors were loaded already
+                }
+            }
+            this->finish_loading();
+        });
+}
 
-    std::vector< int > sensor_ids;
-    for (auto& sensor : xml.get_child("output.sensors")) {
-        if (sensor.first != "sensor") {
-            continue;
-        }
-        auto sensor_id = sensor.second.get< int >("<xmlattr>.id", -1);
-        auto name = sensor.second.get< std::string >("<xmlattr>.name", "N.N.");
-        auto unit = sensor.second.get< std::string >("<xmlattr>.unit", "");
-        this->_sensors.emplace_back(name, unit);
-        sensor_ids.push_back(sensor_id);
+rlib::xml::xml_reader::~xml_reader()
+{
+    // The loader uses the members, it has to end before they are destroyed
+    if (this->_async_loader.valid()) {
+        this->_async_loader.wait();
     }
+}
 
-    for (auto& data : xml.get_child("output.dataset")) {
-        if (data.first != "data") {
-            continue;
-        }
-        rlib::common::sample datum;
-        {
-            datum.time = data.second.get< double >("<xmlattr>.time", -1.0);
+void rlib::xml::xml_reader::load(std::promise< void >& sensor_loaded)
+{
+    rlib::common::mapped_file xml(
+        this->_filename, rlib::common::mapped_file::access::SEQUENTIAL);
+    {
+        std::lock_guard< std::mutex > lock(this->_loader_mutex);
+        this->_total_bytes = xml.size();
+    }
+    this->parse(xml.data(), xml.data() + xml.size(), sensor_loaded);
+}
+
+void rlib::xml::xml_reader::parse(
+    const char* begin, const char* end, std::promise< void >& sensor_loaded)
+{
+    const double nan = std::numeric_limits< double >::quiet_NaN();
+    rlib::xml::xml_pull_parser parser(begin, end);
+    std::vector< std::string_view > path;
+    auto at = [&path](std::initializer_list< std::string_view > names) {
+        return std::equal(path.begin(), path.end(), names.begin(), names.end());
+    };
+    auto attribute = [&parser](std::string_view name) {
+        std::string_view value;
+        parser.attribute(name, value);
+        return value;
+    };
+
+    // Columns of the values of each sensor id (sensors sharing an id share
+    // their values)
+    std::unordered_map< int64_t, std::vector< size_t > > columns;
+    // Sensors are published before the first dataset, sensors declared
+    // after it are ignored
+    bool sensors_loaded = false;
+    auto publish_sensors = [&]() {
+        if (!sensors_loaded) {
+            sensors_loaded = true;
+            sensor_loaded.set_value();
         }
-        std::map< int, double > values;
+    };
+    // Rows parsed but not published yet, the last one may still get values
+    std::vector< double > times;
+    std::vector< double > values;
+    double last_time = -std::numeric_limits< double >::infinity();
+    bool ordered = true;
+    const char* next_publish = begin + PUBLISH_BYTES;
+    auto publish_rows = [&]() {
         {
-            for (auto& value : data.second.get_child("")) {
-                if (value.first != "value") {
-                    continue;
-                }
-                auto sensor_id = value.second.get< int >("<xmlattr>.sensor");
-                auto sensor_value =
-                    value.second.get< double >("<xmlattr>.value");
-                values[ sensor_id ] = sensor_value;
+            std::lock_guard< std::mutex > lock(this->_loader_mutex);
+            this->_times.insert(this->_times.end(), times.begin(), times.end());
+            this->_values.insert(
+                this->_values.end(), values.begin(), values.end());
+            this->_loaded_ordered = ordered;
+            if (!this->_times.empty()) {
+                this->_loaded_until = this->_times.back();
             }
+            this->_loaded_bytes = uint64_t(parser.position() - begin);
         }
-        for (auto sensor_id : sensor_ids) {
-            if (values.count(sensor_id) < 1) {
-                values[ sensor_id ] =
-                    std::numeric_limits< double >::quiet_NaN();
+        this->_loader_progress.notify_all();
+        times.clear();
+        values.clear();
+        next_publish = parser.position() + PUBLISH_BYTES;
+    };
+    rlib::common::event_data event;
+    std::string raw_data;
+    // Text of the element currently read (message or data of an event)
+    std::string* text = nullptr;
+
+    using node = rlib::xml::xml_pull_parser::node;
+    for (auto n = parser.next(); n != node::DONE; n = parser.next()) {
+        if (n == node::TEXT) {
+            if (text != nullptr) {
+                text->append(parser.text());
             }
-            datum.values.push_back(values[ sensor_id ]);
-        }
-        if (datum.values.size() != this->_sensors.size()) {
             continue;
         }
-        this->_data.push_back(std::move(datum));
-    }
-
-    for (auto& event : xml.get_child("output.events")) {
-        if (event.first != "event") {
+        if (n == node::END) {
+            if (path.empty() || path.back() != parser.name()) {
+                throw std::runtime_error("Mismatched xml end tag in " +
+                                         this->_filename);
+            }
+            if (at({ "output", "events", "event" })) {
+                event.raw_data.clear();
+                for (size_t i = 0; i + 1 < raw_data.size(); i += 2) {
+                    event.raw_data.push_back(static_cast< unsigned char >(
+                        (hex_value(raw_data[ i ]) << 4) |
+                        hex_value(raw_data[ i + 1 ])));
+                }
+                this->_events.add(event);
+            }
+            else if (at({ "output", "dataset", "data" }) &&
+                     parser.position() >= next_publish) {
+                publish_rows();
+            }
+            text = nullptr;
+            path.pop_back();
             continue;
         }
 
-        rlib::common::event_data e;
-        {
-            e.event_level = static_cast< rlib::common::event_data_level >(
-                event.second.get< int64_t >("<xmlattr>.level"));
-            e.time = event.second.get< double >("<xmlattr>.time");
-            e.origin = event.second.get< int >("<xmlattr>.origin");
-            e.message = event.second.get< std::string >("message", "");
-
-            auto raw_data = event.second.get< std::string >("data", "");
-            if (!raw_data.empty()) {
-                std::string chars = "0123456789ABCDEF";
-                for (size_t i = 0; i + 1 < raw_data.size(); i += 2) {
-                    std::byte b =
-                        static_cast< std::byte >(chars.find(raw_data[ i ]))
-                        << 4;
-                    b |=
-                        static_cast< std::byte >(chars.find(raw_data[ i + 1 ]));
-                    e.raw_data.push_back(static_cast< unsigned char >(b));
+        path.push_back(parser.name());
+        if (at({ "output", "dataset", "data", "value" })) {
+            // Sensors are declared before the dataset, values of unknown
+            // sensors are ignored
+            auto column = columns.find(parse_int(attribute("sensor"), -1));
+            if (column != columns.end() && !times.empty()) {
+                const size_t row = values.size() - this->_sensors.size();
+                const double value = parse_double(attribute("value"), nan);
+                for (auto sensor : column->second) {
+                    values[ row + sensor ] = value;
                 }
             }
         }
-        this->_events.push_back(std::move(e));
+        else if (at({ "output", "dataset", "data" })) {
+            times.push_back(parse_double(attribute("time"), -1.0));
+            values.resize(values.size() + this->_sensors.size(), nan);
+            ordered = ordered && times.back() >= last_time;
+            last_time = std::fmax(last_time, times.back());
+        }
+        else if (at({ "output", "dataset" })) {
+            publish_sensors();
+        }
+        else if (at({ "output", "sensors", "sensor" }) && !sensors_loaded) {
+            auto name = attribute("name");
+            columns[ parse_int(attribute("id"), -1) ].push_back(
+                this->_sensors.size());
+            this->_sensors.emplace_back(
+                name.empty() ? std::string("N.N.") : decode_entities(name),
+                decode_entities(attribute("unit")));
+        }
+        else if (at({ "output", "events", "event" })) {
+            event.event_level = static_cast< rlib::common::event_data_level >(
+                parse_int(attribute("level"), 0));
+            event.time = parse_double(attribute("time"), 0.0);
+            event.origin = parse_int(attribute("origin"), 0);
+            event.message.clear();
+            raw_data.clear();
+        }
+        else if (at({ "output", "events", "event", "message" })) {
+            event.message.clear();
+            text = &event.message;
+        }
+        else if (at({ "output", "events", "event", "data" })) {
+            raw_data.clear();
+            text = &raw_data;
+        }
     }
+    publish_sensors();
+    publish_rows();
+    std::lock_guard< std::mutex > lock(this->_loader_mutex);
+    this->sort_by_time();
+}
+
+void rlib::xml::xml_reader::sort_by_time()
+{
+    this->_events.sort_by_time();
+    if (std::is_sorted(this->_times.begin(), this->_times.end())) {
+        return;
+    }
+    const size_t width = this->_sensors.size();
+    std::vector< size_t > order(this->_times.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return this->_times[ a ] < this->_times[ b ];
+    });
+    std::vector< double > times(this->_times.size());
+    std::vector< double > values(this->_values.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        times[ i ] = this->_times[ order[ i ] ];
+        std::copy_n(this->_values.begin() + order[ i ] * width, width,
+            values.begin() + i * width);
+    }
+    this->_times = std::move(times);
+    this->_values = std::move(values);
 }
 
 std::string rlib::xml::xml_reader::filename()
@@ -129,8 +273,34 @@ std::string rlib::xml::xml_reader::filename()
     return this->_filename;
 }
 
+void rlib::xml::xml_reader::finish_loading()
+{
+    {
+        std::lock_guard< std::mutex > lock(this->_loader_mutex);
+        this->_async_loader_finished = true;
+        this->_loaded_bytes = this->_total_bytes;
+    }
+    this->_loader_progress.notify_all();
+}
+
+void rlib::xml::xml_reader::wait_until_loaded(
+    std::unique_lock< std::mutex >& lock, double time)
+{
+    // Once a row after time is published all rows till time are (as long as
+    // the rows are ordered)
+    this->_loader_progress.wait(lock, [&]() {
+        return this->_async_loader_finished ||
+               (time >= 0.0 && this->_loaded_ordered &&
+                   this->_loaded_until > time);
+    });
+    if (this->_loader_error) {
+        std::rethrow_exception(this->_loader_error);
+    }
+}
+
 std::vector< rlib::common::sensor > rlib::xml::xml_reader::sensors()
 {
+    this->_async_loader_sensor.get();
     return this->_sensors;
 }
 
@@ -138,18 +308,22 @@ std::vector< rlib::common::sample > rlib::xml::xml_reader::samples(
     double begin, double end)
 {
     begin = std::fmax(begin, 0.0);
+    // Ranges which are loaded already are returned while the loader goes on
+    std::unique_lock< std::mutex > lock(this->_loader_mutex);
+    this->wait_until_loaded(lock, end);
     if (end < 0) {
-        end = this->length();
+        end = this->_times.empty() ? 0.0 : this->_times.back();
     }
-    std::vector< rlib::common::sample > returnData;
-    for (auto& d : this->_data) {
-        if (d.time < begin) {
-            continue;
-        }
-        if (d.time > end) {
-            break;
-        }
-        returnData.push_back(d);
+    auto first =
+        std::lower_bound(this->_times.begin(), this->_times.end(), begin);
+    auto last = std::upper_bound(first, this->_times.end(), end);
+    const size_t width = this->_sensors.size();
+    std::vector< rlib::common::sample > returnData(size_t(last - first));
+    for (size_t i = 0; i < returnData.size(); ++i) {
+        const size_t row = size_t(first - this->_times.begin()) + i;
+        returnData[ i ].time = this->_times[ row ];
+        returnData[ i ].values.assign(this->_values.begin() + row * width,
+            this->_values.begin() + (row + 1) * width);
     }
     return returnData;
 }
@@ -157,15 +331,55 @@ std::vector< rlib::common::sample > rlib::xml::xml_reader::samples(
 std::vector< rlib::common::event_data > rlib::xml::xml_reader::events(
     double begin, double end)
 {
+    std::unique_lock< std::mutex > lock(this->_loader_mutex);
+    this->wait_until_loaded(lock, -1.0);
+    return this->_events.events(begin, end);
+}
 
-    return this->_events;
+std::vector< rlib::common::event_data > rlib::xml::xml_reader::
+    events_of_origin(double begin, double end, int64_t origin)
+{
+    std::unique_lock< std::mutex > lock(this->_loader_mutex);
+    this->wait_until_loaded(lock, -1.0);
+    return this->_events.events_of_origin(begin, end, origin);
+}
+
+std::vector< rlib::common::event_data > rlib::xml::xml_reader::
+    events_of_level(
+        double begin, double end, rlib::common::event_data_level level)
+{
+    std::unique_lock< std::mutex > lock(this->_loader_mutex);
+    this->wait_until_loaded(lock, -1.0);
+    return this->_events.events_of_level(begin, end, level);
 }
 
 double rlib::xml::xml_reader::length()
 {
+    std::unique_lock< std::mutex > lock(this->_loader_mutex);
+    this->wait_until_loaded(lock, -1.0);
     double length = 0.0;
-    if (!this->_data.empty()) {
-        length = this->_data.at(this->_data.size() - 1).time;
+    if (!this->_times.empty()) {
+        length = this->_times.back();
     }
     return length;
 }
+
+double rlib::xml::xml_reader::loaded_until()
+{
+    {
+        std::lock_guard< std::mutex > lock(this->_loader_mutex);
+        if (!this->_async_loader_finished) {
+            return this->_loaded_ordered ? this->_loaded_until : 0.0;
+        }
+    }
+    return this->length();
+}
+
+double rlib::xml::xml_reader::progress()
+{
+    std::lock_guard< std::mutex > lock(this->_loader_mutex);
+    if (this->_async_loader_finished || this->_total_bytes == 0) {
+        return this->_async_loader_finished ? 1.0 : 0.0;
+    }
+    return double(this->_loaded_bytes) / double(this->_total_bytes);
+}
@@ -24,25 +24,69 @@
 #pragma once
 
 // Own
+#include "rlib/common/event_store.h"
 #include "rlib/common/reader.h"
 #include "rlib/common/sample.h"
 #include "rlib/common/sensor.h"
 
 // StdLib
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <mutex>
 #include <string>
 #include <vector>
 
 namespace rlib::xml {
     class xml_reader : public common::reader {
         private:
+        // Min. number of bytes parsed before the rows read so far are
+        // published while loading
+        constexpr static size_t PUBLISH_BYTES = 4 << 20;
+
         std::vector< common::sensor > _sensors;
-        std::vector< common::sample > _data;
-        std::vector< common::event_data > _events;
+        // Samples in columns, the times in ascending order (which are the
+        // index of range queries) and the values row by row
+        std::vector< double > _times;
+        std::vector< double > _values;
+        common::event_store _events;
         std::string _filename;
 
+        std::future< void > _async_loader;
+        std::shared_future< void > _async_loader_sensor;
+        // Guards the rows and the progress while the loader appends rows
+        std::mutex _loader_mutex;
+        std::condition_variable _loader_progress;
+        bool _async_loader_finished = false;
+        // Time of the last row published so far
+        double _loaded_until = 0.0;
+        // Whether the rows published so far are ordered by time, rows of an
+        // unordered dataset are only returned once all are loaded and sorted
+        bool _loaded_ordered = true;
+        uint64_t _loaded_bytes = 0;
+        uint64_t _total_bytes = 0;
+        // Error which ended the loader, rethrown to the callers
+        std::exception_ptr _loader_error;
+
+        // Reads the document, runs asynchronously
+        void load(std::promise< void >& sensor_loaded);
+        // Parses the document [begin, end) without building a tree of it.
+        // The sensors are published before the first dataset, the rows every
+        // PUBLISH_BYTES.
+        void parse(const char* begin, const char* end,
+            std::promise< void >& sensor_loaded);
+        void sort_by_time();
+        void finish_loading();
+        // Waits till all rows until time (in seconds, < 0 => all rows and
+        // events) are loaded
+        void wait_until_loaded(
+            std::unique_lock< std::mutex >& lock, double time);
+
         public:
         xml_reader(std::string filename);
-        virtual ~xml_reader() override = default;
+        virtual ~xml_reader() override;
 
         virtual std::string filename() override final;
         virtual std::vector< common::sensor > sensors() override final;
@@ -50,6 +94,12 @@ namespace rlib::xml {
             double begin, double end) override final;
         virtual std::vector< common::event_data > events(
             double begin, double end) override final;
+        virtual std::vector< common::event_data > events_of_origin(
+            double begin, double end, int64_t origin) override final;
+        virtual std::vector< common::event_data > events_of_level(double begin,
+            double end, common::event_data_level level) override final;
         virtual double length() override final;
+        virtual double loaded_until() override final;
+        virtual double progress() override final;
     };
 }
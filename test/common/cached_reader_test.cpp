@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+
+// Own
+#include <rlib/common/cached_reader.h>
+#include <rlib/common/event_data.h>
+#include <rlib/common/synthetic_reader.h>
+
+// StdLib
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Synthetic reader with events on chunk borders of the cached reader (5.0,
+// twice, and 10.0), events are read inclusive or exclusive of the end of a
+// range
+static std::shared_ptr< rlib::common::reader > border_reader(bool inclusive)
+{
+    auto events = [inclusive](double begin, double end) {
+        const std::vector< std::pair< double, int64_t > > all = { { 2.0, 0 },
+            { 5.0, 0 }, { 5.0, 1 }, { 7.5, -1 }, { 10.0, 1 }, { 15.0, 0 } };
+        std::vector< rlib::common::event_data > result;
+        for (auto& entry : all) {
+            if (entry.first >= begin &&
+                (inclusive ? entry.first <= end : entry.first < end)) {
+                rlib::common::event_data event;
+                {
+                    event.time = entry.first;
+                    event.origin = entry.second;
+                    event.message = std::to_string(entry.first);
+                }
+                result.push_back(event);
+            }
+        }
+        return result;
+    };
+    std::vector< std::function< double(double) > > sensors = { [](double t) {
+        return t;
+    } };
+    return std::make_shared< rlib::common::synthetic_reader >(
+        [](double t) { return t + 0.5; }, events, sensors, 20.0);
+}
+
+int main(int, char* [])
+{
+    // Ranges whose end is no event, so both kinds of readers agree
+    const std::vector< std::pair< double, double > > ranges = { { 0.0, -1.0 },
+        { 0.0, 6.0 }, { 4.0, 11.0 }, { 5.0, 5.5 }, { 9.0, 16.0 },
+        { 1.0, 19.0 }, { 5.5, 9.0 }, { 10.0, 12.0 } };
+    for (bool inclusive : { true, false }) {
+        auto reader = border_reader(inclusive);
+        rlib::common::cached_reader cached(reader);
+        // Twice, the second pass uses the cached chunks
+        for (int pass = 0; pass < 2; ++pass) {
+            for (auto& range : ranges) {
+                auto expected = reader->events(range.first, range.second);
+                auto events = cached.events(range.first, range.second);
+                bool equal = events.size() == expected.size();
+                for (size_t i = 0; equal && i < events.size(); ++i) {
+                    equal = events[ i ].time == expected[ i ].time &&
+                            events[ i ].origin == expected[ i ].origin &&
+                            events[ i ].message == expected[ i ].message;
+                }
+                if (!equal) {
+                    std::cerr << "Events from " << range.first << " till "
+                              << range.second << " differ (inclusive "
+                              << inclusive << ")" << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+
+// Own
+#include <rlib/common/decode.h>
+
+// StdLib
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using rlib::common::kernel;
+
+int main(int, char* [])
+{
+    // Values covering NaN, signed zeros, infinities and subnormals (as f32
+    // and as f64, the latter flush to zero when narrowed)
+    const std::vector< double > specials = {
+        std::numeric_limits< double >::quiet_NaN(),
+        -std::numeric_limits< double >::quiet_NaN(), 0.0, -0.0,
+        double(std::numeric_limits< float >::denorm_min()),
+        -double(std::numeric_limits< float >::denorm_min()),
+        double(std::numeric_limits< float >::min()) / 3.0,
+        std::numeric_limits< double >::denorm_min(),
+        std::numeric_limits< double >::infinity(),
+        -std::numeric_limits< double >::infinity(), 1.0, -2.5, 3.0e38,
+        1.0e-40, 123456.789, -0.1, 7.0
+    };
+    const size_t max_count = 17;
+    const size_t max_offset = 7;
+
+    auto result = EXIT_SUCCESS;
+    for (auto k : { kernel::SSE2, kernel::AVX2 }) {
+        if (!rlib::common::kernel_supported(k)) {
+            std::cout << "Kernel " << int(k) << " not supported" << std::endl;
+            continue;
+        }
+        for (size_t count = 0; count <= max_count; ++count) {
+            for (size_t offset = 0; offset <= max_offset; ++offset) {
+                std::vector< double > values(count + offset);
+                for (size_t i = 0; i < values.size(); ++i) {
+                    values[ i ] = specials[ (i + count) % specials.size() ];
+                }
+
+                // Encode from unaligned doubles into unaligned bytes
+                std::vector< char > expected_raw(
+                    count * sizeof(float) + offset, char(0x55));
+                std::vector< char > raw(expected_raw);
+                rlib::common::encode_f32_be(values.data() + offset, count,
+                    expected_raw.data() + offset, kernel::SCALAR);
+                rlib::common::encode_f32_be(
+                    values.data() + offset, count, raw.data() + offset, k);
+                if (raw != expected_raw) {
+                    std::cerr << "Encode mismatch (kernel " << int(k)
+                              << ", count " << count << ", offset " << offset
+                              << ")" << std::endl;
+                    result = EXIT_FAILURE;
+                }
+
+                // Decode from unaligned bytes into unaligned doubles
+                std::vector< double > expected(count + offset, 42.0);
+                std::vector< double > decoded(expected);
+                rlib::common::decode_f32_be(expected_raw.data() + offset,
+                    count, expected.data() + offset, kernel::SCALAR);
+                rlib::common::decode_f32_be(expected_raw.data() + offset,
+                    count, decoded.data() + offset, k);
+                if (std::memcmp(decoded.data(), expected.data(),
+                        expected.size() * sizeof(double))
+                    != 0) {
+                    std::cerr << "Decode mismatch (kernel " << int(k)
+                              << ", count " << count << ", offset " << offset
+                              << ")" << std::endl;
+                    result = EXIT_FAILURE;
+                }
+
+                // The scalar round trip keeps every f32 value
+                for (size_t i = 0; i < count; ++i) {
+                    double value = values[ offset + i ];
+                    double narrowed = double(float(value));
+                    double decoded_value = decoded[ offset + i ];
+                    if (std::isnan(value) ? !std::isnan(decoded_value)
+                                          : std::memcmp(&narrowed,
+                                                &decoded_value,
+                                                sizeof(double))
+                                != 0) {
+                        std::cerr << "Round trip mismatch for " << value
+                                  << std::endl;
+                        result = EXIT_FAILURE;
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+
+// Own
+#include <rlib/common/event_store.h>
+
+// StdLib
+#include <cstdlib>
+#include <vector>
+
+int main(int, char* [])
+{
+    rlib::common::event_store store;
+    // Added out of order, messages repeat
+    std::vector< unsigned char > raw = { 0x01, 0xAB };
+    for (int i = 999; i >= 0; --i) {
+        store.add(double(i) / 10.0,
+            static_cast< rlib::common::event_data_level >(i % 4), i % 3 - 1,
+            i % 2 == 0 ? "even" : "odd", raw.data(), size_t(i % 3));
+    }
+    store.sort_by_time();
+    if (store.size() != 1000) {
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < store.size(); ++i) {
+        auto event = store.at(i);
+        if (event.time != double(i) / 10.0 ||
+            event.origin != int64_t(i % 3) - 1 ||
+            event.message != (i % 2 == 0 ? "even" : "odd") ||
+            event.raw_data.size() != i % 3 ||
+            (!event.raw_data.empty() && event.raw_data[ 0 ] != 0x01)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Ranges include both ends, end < 0 => till the last event
+    if (store.events(10.0, 20.0).size() != 101 ||
+        store.events(0.0, -1.0).size() != 1000 ||
+        store.events(99.95, 200.0).size() != 0) {
+        return EXIT_FAILURE;
+    }
+    auto global = store.events_of_origin(10.0, 20.0, -1);
+    for (auto& event : global) {
+        if (event.origin != -1 || event.time < 10.0 || event.time > 20.0) {
+            return EXIT_FAILURE;
+        }
+    }
+    // Events 102, 105, ..., 198
+    if (global.size() != 33) {
+        return EXIT_FAILURE;
+    }
+    auto warnings = store.events_of_level(
+        0.0, 1.0, rlib::common::event_data_level::WARNING);
+    if (warnings.size() != 3 || warnings[ 0 ].time != 0.2) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+
+// Own
+#include <rlib/common/mapped_file.h>
+
+// StdLib
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using rlib::common::mapped_file;
+
+int main(int, char* [])
+{
+    std::string empty_name = std::tmpnam(nullptr);
+    std::string data_name = std::tmpnam(nullptr);
+    std::string missing_name = std::tmpnam(nullptr);
+    std::ofstream(empty_name, std::ios::binary).flush();
+    std::string content;
+    for (size_t i = 0; i < 3 * 4096 + 123; ++i) {
+        content.push_back(char('a' + i % 26));
+    }
+    std::ofstream(data_name, std::ios::binary) << content;
+    auto result = EXIT_SUCCESS;
+    auto check = [&result](bool ok) {
+        if (!ok) {
+            result = EXIT_FAILURE;
+        }
+    };
+
+    // An empty file has no mapping, hints are ignored
+    {
+        mapped_file empty(empty_name, mapped_file::access::SEQUENTIAL);
+        check(empty.size() == 0 && empty.data() == nullptr);
+        empty.advise(mapped_file::access::WILL_NEED, 0, 100);
+    }
+
+    // A missing file names the file in the exception
+    try {
+        mapped_file missing(missing_name);
+        check(false);
+    }
+    catch (std::runtime_error& e) {
+        check(std::string(e.what()).find("Can not open file " +
+                                         missing_name) == 0);
+    }
+
+    {
+        mapped_file data(data_name, mapped_file::access::RANDOM);
+        check(data.size() == content.size() &&
+              std::memcmp(data.data(), content.data(), content.size()) == 0);
+        // Unaligned offsets, lengths past the end and offsets past the end
+        data.advise(mapped_file::access::WILL_NEED, 1, SIZE_MAX);
+        data.advise(mapped_file::access::SEQUENTIAL, 4097, 10 * 4096);
+        data.advise(mapped_file::access::RANDOM, content.size() - 1, 1);
+        data.advise(mapped_file::access::NORMAL, content.size() + 4096, 1);
+        check(std::memcmp(data.data(), content.data(), content.size()) == 0);
+        // Reads do not need to be aligned
+        uint32_t value;
+        std::memcpy(&value, content.data() + 4095, sizeof(value));
+        check(data.read< uint32_t >(4095) == value);
+
+        // Move construction and assignment hand over the mapping
+        mapped_file empty(empty_name);
+        mapped_file moved(std::move(data));
+        check(data.data() == nullptr && data.size() == 0);
+        empty = std::move(moved);
+        check(empty.size() == content.size() &&
+              empty.filename() == data_name &&
+              std::memcmp(empty.data(), content.data(), content.size()) == 0);
+        check(moved.filename() == empty_name && moved.size() == 0);
+    }
+
+    std::remove(empty_name.c_str());
+    std::remove(data_name.c_str());
+    return result;
+}
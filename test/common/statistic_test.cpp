@@ -0,0 +1,258 @@
+/**
+ * Copyright (c) 2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+
+// Own
+#include "util/test_helper.h"
+#include <rlib/common/statistic_reader.h>
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+int main(int, char* [])
+{
+    // Enough samples to need more than one pass for the median
+    auto succeedingTime = [](double t) {
+        return std::round(t * 10000.0 + 1.0) / 10000.0;
+    };
+    auto events = [](double begin, double end) {
+        return std::vector< rlib::common::event_data >();
+    };
+    std::vector< std::function< double(double) > > sensors = {
+        [](double t) { return std::sin(t); }, [](double t) { return t * t; },
+        [](double t) { return 1.5; }
+    };
+    auto syn_reader = std::make_shared< rlib::common::synthetic_reader >(
+        succeedingTime, events, sensors);
+    rlib::common::statistic_reader reader(syn_reader);
+
+    auto data = syn_reader->samples(0.0, -1.0);
+    auto min = reader.statistic(rlib::common::statistic_data::MIN_VALUE);
+    auto max = reader.statistic(rlib::common::statistic_data::MAX_VALUE);
+    auto avg = reader.statistic(rlib::common::statistic_data::AVG_VALUE);
+    auto var = reader.statistic(rlib::common::statistic_data::VAR_VALUE);
+    auto median = reader.statistic(rlib::common::statistic_data::MEDIAN_VALUE);
+    for (size_t sensor = 0; sensor < sensors.size(); ++sensor) {
+        std::vector< double > values;
+        for (auto& datum : data) {
+            values.push_back(datum.values[ sensor ]);
+        }
+        std::sort(values.begin(), values.end());
+        double mean = 0.0;
+        for (auto value : values) {
+            mean += value;
+        }
+        mean /= double(values.size());
+        double variance = 0.0;
+        for (auto value : values) {
+            variance += (value - mean) * (value - mean);
+        }
+        variance /= double(values.size());
+        double mid = (values[ (values.size() - 1) / 2 ] +
+                         values[ values.size() / 2 ]) /
+                     2.0;
+
+        if (!min[ sensor ] || *min[ sensor ] != values.front()) {
+            return EXIT_FAILURE;
+        }
+        if (!max[ sensor ] || *max[ sensor ] != values.back()) {
+            return EXIT_FAILURE;
+        }
+        if (!avg[ sensor ] || std::fabs(*avg[ sensor ] - mean) > 1e-9) {
+            return EXIT_FAILURE;
+        }
+        if (!var[ sensor ] || std::fabs(*var[ sensor ] - variance) > 1e-9) {
+            return EXIT_FAILURE;
+        }
+        if (!median[ sensor ] || *median[ sensor ] != mid) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Medians with infinite bounds (only the finite values are binned) and
+    // with a width overflowing a double
+    std::vector< std::function< double(double) > > extremes = {
+        [](double t) {
+            if (t < 1e-5) {
+                return -std::numeric_limits< double >::infinity();
+            }
+            if (t > 10.0 - 1e-5) {
+                return std::numeric_limits< double >::infinity();
+            }
+            return std::cos(t);
+        },
+        [](double t) {
+            if (t < 1e-5) {
+                return -std::numeric_limits< double >::max();
+            }
+            if (t > 10.0 - 1e-5) {
+                return std::numeric_limits< double >::max();
+            }
+            return t;
+        }
+    };
+    auto extreme_reader = std::make_shared< rlib::common::synthetic_reader >(
+        succeedingTime, events, extremes);
+    auto extreme_data = extreme_reader->samples(0.0, -1.0);
+    auto extreme_median =
+        rlib::common::statistic_reader(extreme_reader)
+            .statistic(rlib::common::statistic_data::MEDIAN_VALUE);
+    for (size_t sensor = 0; sensor < extremes.size(); ++sensor) {
+        std::vector< double > values;
+        for (auto& datum : extreme_data) {
+            values.push_back(datum.values[ sensor ]);
+        }
+        std::sort(values.begin(), values.end());
+        double mid = (values[ (values.size() - 1) / 2 ] +
+                         values[ values.size() / 2 ]) /
+                     2.0;
+        if (!extreme_median[ sensor ] || *extreme_median[ sensor ] != mid) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Ranges (within one block, over block borders and till the end)
+    std::vector< std::pair< double, double > > ranges = { { 0.5, 1.5 },
+        { 2.25, 9.75 }, { 0.0, 5.0 }, { 4.9, -1.0 } };
+    for (auto& range : ranges) {
+        for (auto t : { rlib::common::statistic_data::MIN_VALUE,
+                 rlib::common::statistic_data::MAX_VALUE,
+                 rlib::common::statistic_data::AVG_VALUE,
+                 rlib::common::statistic_data::VAR_VALUE,
+                 rlib::common::statistic_data::MEDIAN_VALUE }) {
+            auto expected = syn_reader->statistic(t, range.first, range.second);
+            auto actual = reader.statistic(t, range.first, range.second);
+            if (expected.size() != actual.size()) {
+                return EXIT_FAILURE;
+            }
+            for (size_t sensor = 0; sensor < expected.size(); ++sensor) {
+                if (!expected[ sensor ] || !actual[ sensor ] ||
+                    std::fabs(*expected[ sensor ] - *actual[ sensor ]) >
+                        1e-9) {
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+    }
+
+    // Sketch based quantiles within their rank error
+    for (auto q : { 0.05, 0.5, 0.95, 0.99 }) {
+        auto actual = reader.quantile(q, 1.0, 9.5);
+        auto lower = reader.exact_quantile(q - 0.02, 1.0, 9.5);
+        auto upper = reader.exact_quantile(q + 0.02, 1.0, 9.5);
+        for (size_t sensor = 0; sensor < actual.size(); ++sensor) {
+            if (!actual[ sensor ] || *actual[ sensor ] < *lower[ sensor ] ||
+                *actual[ sensor ] > *upper[ sensor ]) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    // Integrals based on the prefix sums (within one block, over block
+    // borders and till the end)
+    for (auto& range : ranges) {
+        double begin = range.first;
+        double end = range.second < 0.0 ? syn_reader->length() : range.second;
+        double last = std::fmin(end, data.back().time);
+        double charge = (last * last * last - begin * begin * begin) / 3.0;
+        for (size_t sensor = 0; sensor < sensors.size(); ++sensor) {
+            auto expected = syn_reader->integral(sensor, begin, end);
+            auto actual = reader.integral(sensor, begin, end);
+            if (!expected || !actual ||
+                std::fabs(*expected - *actual) > 1e-9) {
+                return EXIT_FAILURE;
+            }
+        }
+        auto integral = reader.integral(1, begin, end);
+        auto energy = reader.energy(1, 2, begin, end);
+        if (!integral || std::fabs(*integral - charge) > 1e-6) {
+            return EXIT_FAILURE;
+        }
+        if (!energy || std::fabs(*energy - 1.5 * charge) > 1e-6) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Histograms merged from the block histograms and scanned ones
+    for (auto& range : ranges) {
+        double end = range.second < 0.0 ? syn_reader->length() : range.second;
+        for (size_t bins : { 1, 16, 100, 7 }) {
+            for (size_t sensor = 0; sensor < sensors.size(); ++sensor) {
+                rlib::common::histogram expected(
+                    *min[ sensor ], *max[ sensor ], bins);
+                for (auto& datum : data) {
+                    if (datum.time >= range.first && datum.time < end) {
+                        expected.add(datum.values[ sensor ]);
+                    }
+                }
+                auto actual =
+                    reader.histogram(sensor, range.first, range.second, bins);
+                if (!actual || expected.counts != actual->counts) {
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+    }
+
+    // Histograms of a recording with more blocks than histogram leaves
+    // (1201 blocks of 5 s, two per leaf). The values are whole numbers
+    // (0 till 96), so coarsened and direct bins agree.
+    auto long_reader = std::make_shared< rlib::common::synthetic_reader >(
+        [](double t) { return t + 1.0; }, events,
+        std::vector< std::function< double(double) > >(
+            { [](double t) { return std::fmod(t, 97.0); } }),
+        6000.0);
+    rlib::common::statistic_reader long_statistic(long_reader);
+    auto long_data = long_reader->samples(0.0, -1.0);
+    auto long_min =
+        long_statistic.statistic(rlib::common::statistic_data::MIN_VALUE);
+    auto long_max =
+        long_statistic.statistic(rlib::common::statistic_data::MAX_VALUE);
+    std::vector< std::pair< double, double > > long_ranges = { { 7.0, 12.0 },
+        { 101.0, 3333.0 }, { 4.0, 5996.0 }, { 0.0, -1.0 } };
+    for (auto& range : long_ranges) {
+        double end = range.second < 0.0 ? long_reader->length() : range.second;
+        for (size_t bins : { 16, 100, 7 }) {
+            rlib::common::histogram expected(
+                *long_min[ 0 ], *long_max[ 0 ], bins);
+            for (auto& datum : long_data) {
+                if (datum.time >= range.first && datum.time < end) {
+                    expected.add(datum.values[ 0 ]);
+                }
+            }
+            auto actual =
+                long_statistic.histogram(0, range.first, range.second, bins);
+            if (!actual || expected.counts != actual->counts) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
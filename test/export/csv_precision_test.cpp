@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+
+// Own
+#include <rlib/common/output_buffer.h>
+#include <rlib/common/synthetic_reader.h>
+#include <rlib/csv/csv_exporter.h>
+#include <rlib/csv/csv_reader.h>
+
+// StdLib
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Extreme, subnormal, signed zero and non finite values, which have to be
+// written so that they read back to the same double
+static const std::vector< double > VALUES = { 0.1, 1.0 / 3.0, -0.0,
+    std::numeric_limits< double >::max(), -std::numeric_limits< double >::max(),
+    std::numeric_limits< double >::min(),
+    std::numeric_limits< double >::denorm_min(),
+    -std::numeric_limits< double >::denorm_min(),
+    std::numeric_limits< double >::min() / 3.0,
+    std::numeric_limits< double >::quiet_NaN(),
+    std::numeric_limits< double >::infinity(),
+    -std::numeric_limits< double >::infinity(), 123456789.123456789 };
+
+// Value which reads back from value written with precision significant
+// digits (< 0 => the value itself)
+static double rounded(double value, int precision)
+{
+    if (precision < 0) {
+        return value;
+    }
+    char text[ 64 ];
+    std::snprintf(text, sizeof(text), "%.*g", precision, value);
+    return std::strtod(text, nullptr);
+}
+
+// Whether a equals b (NaN matches NaN, zeros have to share their sign)
+static bool same(double a, double b)
+{
+    if (std::isnan(a) || std::isnan(b)) {
+        return std::isnan(a) && std::isnan(b);
+    }
+    return a == b && std::signbit(a) == std::signbit(b);
+}
+
+// Exports the reader with precision and compares the csv read back with the
+// samples of the reader
+static bool check_round_trip(
+    std::shared_ptr< rlib::common::reader > src_reader, int precision)
+{
+    std::string filename = std::string(std::tmpnam(nullptr)) + ".csv";
+    {
+        rlib::csv::csv_exporter exporter(src_reader, precision);
+        std::ofstream output(filename, std::ios::binary);
+        exporter.data_export(0.0, -1.0, output);
+    }
+    auto src_data = src_reader->samples(0.0, -1.0);
+    std::vector< rlib::common::sample > data;
+    {
+        rlib::csv::csv_reader reader(filename);
+        data = reader.samples(0.0, -1.0);
+    }
+    std::remove(filename.c_str());
+    if (data.size() != src_data.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (!same(data[ i ].time, rounded(src_data[ i ].time, precision)) ||
+            data[ i ].values.size() != src_data[ i ].values.size()) {
+            return false;
+        }
+        for (size_t j = 0; j < data[ i ].values.size(); ++j) {
+            if (!same(data[ i ].values[ j ],
+                    rounded(src_data[ i ].values[ j ], precision))) {
+                std::cerr << "Row " << i << " value " << j << " failed"
+                          << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int, char* [])
+{
+    // Times in steps of 0.1 have no short exact representation either, the
+    // sensors cycle through all values shifted by their index
+    auto succeedingTime = [](double t) { return t + 0.1; };
+    auto events = [](double, double) {
+        return std::vector< rlib::common::event_data >();
+    };
+    std::vector< std::function< double(double) > > sensors;
+    for (size_t j = 0; j < 3; ++j) {
+        sensors.push_back([j](double t) {
+            return VALUES[ (size_t(std::lround(t * 10.0)) + j) %
+                           VALUES.size() ];
+        });
+    }
+    auto src_reader = std::make_shared< rlib::common::synthetic_reader >(
+        succeedingTime, events, sensors, 5.0);
+
+    for (int precision :
+        { rlib::common::output_buffer::SHORTEST, 17, 6, 3, 1 }) {
+        if (!check_round_trip(src_reader, precision)) {
+            std::cerr << "Precision " << precision << " failed" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -25,16 +25,129 @@
 
 // Own
 #include "util/test_helper.h"
+#include <rlib/keysight/dlog.h>
 #include <rlib/keysight/dlog_exporter.h>
+#include <rlib/keysight/dlog_reader.h>
 
 // StdLib
+#include <cmath>
 #include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Reader of records values at interval, with the units dlog needs: channel 1
+// with a current and a voltage and channel 2 with a current which is NaN
+class unit_reader : public rlib::common::reader {
+    private:
+    size_t _records;
+    double _interval;
+    // Whether the sensors know the interval
+    bool _known_interval;
+
+    public:
+    unit_reader(size_t records, double interval, bool known_interval)
+        : _records(records)
+        , _interval(interval)
+        , _known_interval(known_interval)
+    {
+    }
+    virtual ~unit_reader() override = default;
+
+    virtual std::string filename() override
+    {
+        return "UNIT_READER";
+    }
+    virtual std::vector< rlib::common::sensor > sensors() override
+    {
+        double interval = this->_known_interval ? this->_interval : -1.0;
+        return { rlib::common::sensor("I1", "A", interval),
+            rlib::common::sensor("U1", "V", interval),
+            rlib::common::sensor("I2", "A", interval) };
+    }
+    virtual std::vector< rlib::common::sample > samples(
+        double begin, double end) override
+    {
+        std::vector< rlib::common::sample > data;
+        for (size_t i = 0; i < this->_records; ++i) {
+            double time = double(i) * this->_interval;
+            if (time < begin || (end >= 0 && time > end)) {
+                continue;
+            }
+            data.emplace_back(time,
+                std::vector< double >({ double(i) * 0.5, -double(i),
+                    std::numeric_limits< double >::quiet_NaN() }));
+        }
+        return data;
+    }
+    virtual std::vector< rlib::common::event_data > events(
+        double begin, double end) override
+    {
+        return {};
+    }
+    virtual double length() override
+    {
+        return double(this->_records - 1) * this->_interval;
+    }
+};
+
+// Exports reader and compares the records read back with dlog_reader
+static bool round_trip(std::shared_ptr< unit_reader > reader, size_t records)
+{
+    std::string filename = std::string(std::tmpnam(nullptr)) + ".dlog";
+    {
+        rlib::keysight::dlog_exporter exporter(reader);
+        std::ofstream output(filename, std::ios::binary);
+        exporter.data_export(0.0, -1, output);
+    }
+    // The records follow the header and 5 zero bytes
+    rlib::keysight::dlog dlog(filename);
+    std::ifstream input(filename, std::ios::binary | std::ios::ate);
+    const size_t size = size_t(input.tellg());
+    if (size != dlog.data_begin_pos + 5 + records * 3 * sizeof(float)) {
+        return false;
+    }
+
+    // Records hold the currents (last channel first) and then the voltages
+    rlib::keysight::dlog_reader dlog_reader(filename);
+    auto sensors = dlog_reader.sensors();
+    auto src_data = reader->samples(0.0, -1.0);
+    auto data = dlog_reader.samples(0.0, -1.0);
+    std::remove(filename.c_str());
+    if (sensors.size() != 3 || sensors[ 0 ].unit != "A" ||
+        sensors[ 2 ].unit != "V" || data.size() != src_data.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < data.size(); ++i) {
+        const auto& src = src_data[ i ].values;
+        const auto& values = data[ i ].values;
+        if (std::fabs(data[ i ].time - src_data[ i ].time) > 1e-9 ||
+            values.size() != 3 || !std::isnan(values[ 0 ]) ||
+            values[ 1 ] != src[ 0 ] || values[ 2 ] != src[ 1 ]) {
+            return false;
+        }
+    }
+    return true;
+}
 
 int main(int, char* [])
 {
     auto syn_reader = gen_syn_reader();
     auto filename1 = std::tmpnam(nullptr);
     auto filename2 = std::tmpnam(nullptr);
-    return test_export_helper< rlib::keysight::dlog_exporter >(
-        syn_reader, filename1, filename2);
+    if (test_export_helper< rlib::keysight::dlog_exporter >(
+            syn_reader, filename1, filename2) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    // 7 and 1000 records of 3 values (no multiple of the 8 values encoded
+    // at once), the interval from the sensors or the samples
+    if (!round_trip(std::make_shared< unit_reader >(7, 0.25, true), 7) ||
+        !round_trip(std::make_shared< unit_reader >(1000, 0.001, true), 1000) ||
+        !round_trip(std::make_shared< unit_reader >(7, 0.25, false), 7)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
 }
@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+
+// Own
+#include "util/test_helper.h"
+#include <rlib/android/meta_exporter.h>
+
+// StdLib
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+// Content of the file filename
+static std::string file_content(std::string filename)
+{
+    std::ifstream input(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator< char >(input),
+        std::istreambuf_iterator< char >());
+}
+
+int main(int, char* [])
+{
+    auto syn_reader = gen_syn_reader();
+    std::string filename1 = std::string(std::tmpnam(nullptr)) + ".meta";
+    std::string filename2 = std::string(std::tmpnam(nullptr)) + ".meta";
+    for (auto& filename : { filename1, filename2 }) {
+        rlib::android::meta_exporter exporter(syn_reader, filename);
+        std::ofstream output(filename, std::ios::binary);
+        exporter.data_export(0.0, -1, output);
+    }
+
+    // The meta does not name the data file, both exports are identical
+    if (file_content(filename1) != file_content(filename2)) {
+        return EXIT_FAILURE;
+    }
+    auto data1 = file_content(
+        filename1.substr(0, filename1.size() - 4) + "data");
+    auto data2 = file_content(
+        filename2.substr(0, filename2.size() - 4) + "data");
+    if (data1.empty() || data1 != data2) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
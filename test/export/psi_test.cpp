@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+
+// Own
+#include "util/test_helper.h"
+#include <rlib/powerscale/psi_exporter.h>
+#include <rlib/powerscale/psi_reader.h>
+
+// StdLib
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Content of the file filename
+static std::string file_content(std::string filename)
+{
+    std::ifstream input(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator< char >(input),
+        std::istreambuf_iterator< char >());
+}
+
+int main(int, char* [])
+{
+    auto syn_reader = gen_syn_reader();
+    std::string filename1 = std::string(std::tmpnam(nullptr)) + ".psi";
+    std::string filename2 = std::string(std::tmpnam(nullptr)) + ".psi";
+    for (auto& filename : { filename1, filename2 }) {
+        rlib::powerscale::psi_exporter exporter(syn_reader, filename);
+        std::ofstream output(filename, std::ios::binary);
+        exporter.data_export(0.0, -1, output);
+    }
+
+    // The psi does not name the psd files, both exports are identical
+    if (file_content(filename1) != file_content(filename2)) {
+        return EXIT_FAILURE;
+    }
+    auto psd1 = file_content(
+        filename1.substr(0, filename1.size() - 4) + "_0.psd");
+    auto psd2 = file_content(
+        filename2.substr(0, filename2.size() - 4) + "_0.psd");
+    if (psd1.empty() || psd1 != psd2) {
+        return EXIT_FAILURE;
+    }
+
+    // Events keep the sensor of their origin (the current of the second
+    // data stream is sensor 2 in both), so a psi exported again has the
+    // same events
+    auto psi_reader1 =
+        std::make_shared< rlib::powerscale::psi_reader >(filename1);
+    std::string filename3 = std::string(std::tmpnam(nullptr)) + ".psi";
+    {
+        rlib::powerscale::psi_exporter exporter(psi_reader1, filename3);
+        std::ofstream output(filename3, std::ios::binary);
+        exporter.data_export(0.0, -1, output);
+    }
+    auto events1 = psi_reader1->events(0.0, -1.0);
+    auto events3 = rlib::powerscale::psi_reader(filename3).events(0.0, -1.0);
+    std::vector< int64_t > origins = { -1, 2, 0 };
+    if (events1.size() != origins.size() || events3.size() != origins.size()) {
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < origins.size(); ++i) {
+        if (events1[ i ].origin != origins[ i ] ||
+            events3[ i ].origin != origins[ i ] ||
+            std::fabs(events3[ i ].time - events1[ i ].time) > 1e-9 ||
+            events3[ i ].raw_data != events1[ i ].raw_data) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+
+// Own
+#include <rlib/common/event_data.h>
+#include <rlib/common/synthetic_reader.h>
+#include <rlib/xml/xml_exporter.h>
+#include <rlib/xml/xml_reader.h>
+
+// StdLib
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Events at the begin and end of the recording, on the borders of the
+// export chunks (twice at 60 s) and with markup and every kind of byte
+static std::vector< rlib::common::event_data > all_events()
+{
+    std::vector< rlib::common::event_data > events;
+    const double times[] = { 0.0, 12.25, 60.0, 60.0, 119.5, 120.0, 130.0 };
+    for (size_t i = 0; i < sizeof(times) / sizeof(times[ 0 ]); ++i) {
+        rlib::common::event_data event;
+        {
+            event.time = times[ i ];
+            event.origin = int64_t(i % 3) - 1;
+            event.event_level =
+                static_cast< rlib::common::event_data_level >(i % 4);
+            event.message = "E" + std::to_string(i) + " a&b<c>\"d\"'e'";
+            event.raw_data = { 0x00, 0x0F, 0x10, 0x7F, 0x80, 0xAB, 0xFF,
+                static_cast< unsigned char >(i) };
+        }
+        events.push_back(event);
+    }
+    events[ 3 ].message.clear();
+    events[ 4 ].raw_data.clear();
+    return events;
+}
+
+// Exports reader from begin till end and compares the events read back
+static bool round_trip(std::shared_ptr< rlib::common::reader > reader,
+    double begin, double end, bool compact)
+{
+    std::string filename = std::string(std::tmpnam(nullptr)) + ".xml";
+    {
+        rlib::xml::xml_exporter exporter(reader, compact);
+        std::ofstream output(filename, std::ios::binary);
+        exporter.data_export(begin, end, output);
+    }
+    rlib::xml::xml_reader xml(filename);
+    auto expected = reader->events(begin, end);
+    auto events = xml.events(0.0, -1.0);
+    std::remove(filename.c_str());
+    if (events.size() != expected.size()) {
+        std::cerr << events.size() << " instead of " << expected.size()
+                  << " events" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events[ i ].time != expected[ i ].time ||
+            events[ i ].origin != expected[ i ].origin ||
+            events[ i ].event_level != expected[ i ].event_level ||
+            events[ i ].message != expected[ i ].message ||
+            events[ i ].raw_data != expected[ i ].raw_data) {
+            std::cerr << "Event " << i << " differs" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int, char* [])
+{
+    // Readers including and excluding the end of a range
+    for (bool inclusive : { true, false }) {
+        auto events = [inclusive](double begin, double end) {
+            std::vector< rlib::common::event_data > result;
+            for (auto& event : all_events()) {
+                if (event.time >= begin &&
+                    (end < 0 ||
+                        (inclusive ? event.time <= end : event.time < end))) {
+                    result.push_back(event);
+                }
+            }
+            return result;
+        };
+        std::vector< std::function< double(double) > > sensors = {
+            [](double t) { return t; }
+        };
+        auto reader = std::make_shared< rlib::common::synthetic_reader >(
+            [](double t) { return t + 1.0; }, events, sensors, 130.0);
+
+        for (bool compact : { false, true }) {
+            if (!round_trip(reader, 0.0, -1.0, compact) ||
+                !round_trip(reader, 60.0, 120.0, compact) ||
+                !round_trip(reader, 10.0, 60.0, compact) ||
+                !round_trip(reader, 0.0, 130.0, compact)) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+#include <sys/stat.h>
+
+// Own
+#include "util/test_helper.h"
+#include <rlib/csv/csv_exporter.h>
+#include <rlib/csv/csv_reader.h>
+
+// StdLib
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// csv_reader keeping only a persisted sparse index of the rows
+class csv_index_reader : public rlib::csv::csv_reader {
+    public:
+    csv_index_reader(std::string filename)
+        : rlib::csv::csv_reader(
+              filename, rlib::csv::csv_storage::INDEX, true)
+    {
+    }
+};
+
+// Whether the ranges of reader match the ones of the rows kept in memory
+static bool check_ranges(
+    rlib::csv::csv_reader& reader, rlib::csv::csv_reader& memory)
+{
+    const std::vector< std::pair< double, double > > ranges = { { 0.0, -1.0 },
+        { 1.005, 2.5 }, { 10.235, 10.245 }, { 10.24, 10.24 },
+        { 20.47, 30.73 }, { 0.0, 0.0 }, { 59.5, 100.0 }, { 30.0, 29.0 } };
+    for (auto& range : ranges) {
+        auto data = reader.samples(range.first, range.second);
+        auto expected = memory.samples(range.first, range.second);
+        if (data.size() != expected.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < data.size(); ++i) {
+            if (data[ i ] != expected[ i ]) {
+                return false;
+            }
+        }
+    }
+    return reader.length() == memory.length();
+}
+
+// Modification time (in ns) of filename, -1 if it does not exist
+static int64_t modification_time(const std::string& filename)
+{
+    struct stat status;
+    if (::stat(filename.c_str(), &status) != 0) {
+        return -1;
+    }
+    return int64_t(status.st_mtim.tv_sec) * 1000000000 +
+           int64_t(status.st_mtim.tv_nsec);
+}
+
+int main(int, char* [])
+{
+    auto syn_reader = gen_syn_reader();
+    auto filename1 = std::tmpnam(nullptr);
+    auto filename2 = std::tmpnam(nullptr);
+    test_export_helper< rlib::csv::csv_exporter >(
+        syn_reader, filename1, filename2);
+    // The second pass reads the persisted index
+    if (test_reader_helper< csv_index_reader >(
+            syn_reader, filename1, filename2) != EXIT_SUCCESS ||
+        test_reader_helper< csv_index_reader >(
+            syn_reader, filename1, filename2) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+    std::remove((std::string(filename1) + ".idx").c_str());
+    std::remove((std::string(filename2) + ".idx").c_str());
+
+    // 6000 rows, several entries of the sparse index
+    std::vector< std::function< double(double) > > sensors = {
+        [](double t) { return std::sin(t); }, [](double t) { return t * 3; }
+    };
+    auto long_reader = std::make_shared< rlib::common::synthetic_reader >(
+        [](double t) { return t + 0.01; },
+        [](double, double) {
+            return std::vector< rlib::common::event_data >();
+        },
+        sensors, 60.0);
+    std::string filename = std::tmpnam(nullptr);
+    std::string index_filename = filename + ".idx";
+    {
+        rlib::csv::csv_exporter exporter(long_reader);
+        std::ofstream output(filename, std::ios::binary);
+        exporter.data_export(0.0, -1, output);
+    }
+    rlib::csv::csv_reader memory(filename);
+    if (memory.samples(0.0, -1.0).size() < 5000) {
+        return EXIT_FAILURE;
+    }
+
+    // The first reader persists the index, the second one reuses it
+    {
+        csv_index_reader reader(filename);
+        if (!check_ranges(reader, memory)) {
+            return EXIT_FAILURE;
+        }
+    }
+    int64_t index_time = modification_time(index_filename);
+    if (index_time < 0) {
+        return EXIT_FAILURE;
+    }
+    {
+        csv_index_reader reader(filename);
+        if (!check_ranges(reader, memory) ||
+            modification_time(index_filename) != index_time) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // An index with a damaged entry count is rebuilt
+    {
+        std::fstream index(
+            index_filename, std::ios::binary | std::ios::in | std::ios::out);
+        uint64_t entries = uint64_t(1) << 60;
+        index.seekp(40);
+        index.write(reinterpret_cast< const char* >(&entries), sizeof(entries));
+    }
+    {
+        csv_index_reader reader(filename);
+        if (!check_ranges(reader, memory)) {
+            return EXIT_FAILURE;
+        }
+    }
+    {
+        csv_index_reader reader(filename);
+        if (!check_ranges(reader, memory)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::remove(index_filename.c_str());
+    std::remove(filename.c_str());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+
+// Own
+#include <rlib/csv/csv_reader.h>
+
+// StdLib
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Writes a csv with columns sensors and the rows 0 till rows - 1 (the time of
+// a row is its number, value j of row i is (i + j) % 10), a blank line
+// follows the header and every 100000th row
+static void write_csv(std::string filename, size_t columns, size_t rows)
+{
+    std::ofstream output(filename, std::ios::binary);
+    output << "Time";
+    for (size_t j = 0; j < columns; ++j) {
+        output << ",S" << j << " (A)";
+    }
+    output << '\n';
+    std::string row;
+    for (size_t i = 0; i < rows; ++i) {
+        if (i % 100000 == 0) {
+            output << '\n';
+        }
+        row = std::to_string(i);
+        for (size_t j = 0; j < columns; ++j) {
+            row += ',';
+            row += char('0' + (i + j) % 10);
+        }
+        row += '\n';
+        output << row;
+    }
+}
+
+// Whether the rows [first, first + count) of the csv are read
+static bool check_rows(rlib::csv::csv_reader& reader, size_t columns,
+    size_t first, size_t count)
+{
+    auto data = reader.samples(double(first), double(first + count - 1));
+    if (data.size() != count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (data[ i ].time != double(first + i) ||
+            data[ i ].values.size() != columns) {
+            return false;
+        }
+        for (size_t j = 0; j < columns; ++j) {
+            if (data[ i ].values[ j ] != double((first + i + j) % 10)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int, char* [])
+{
+    // 400 columns behind a blank line (4.8 MB, more than one chunk), the
+    // rows reserved for a chunk must not be estimated from the blank line
+    std::string wide_filename = std::string(std::tmpnam(nullptr)) + ".csv";
+    write_csv(wide_filename, 400, 6000);
+    {
+        rlib::csv::csv_reader reader(wide_filename);
+        if (reader.sensors().size() != 400 ||
+            !check_rows(reader, 400, 0, 6000) || reader.length() != 5999.0) {
+            std::remove(wide_filename.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    std::remove(wide_filename.c_str());
+
+    // 38 MB are split into chunks of 4 MiB, parsed (or indexed) in three
+    // batches. Rows are checked in ranges over all chunk borders.
+    const size_t rows = 2400000;
+    std::string filename = std::string(std::tmpnam(nullptr)) + ".csv";
+    write_csv(filename, 4, rows);
+    for (auto storage :
+        { rlib::csv::csv_storage::MEMORY, rlib::csv::csv_storage::INDEX }) {
+        rlib::csv::csv_reader reader(filename, storage);
+        bool valid = reader.length() == double(rows - 1) &&
+                     reader.progress() == 1.0;
+        for (size_t first = 0; valid && first < rows; first += 200000) {
+            valid = check_rows(reader, 4, first, 200000);
+        }
+        if (!valid) {
+            std::remove(filename.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    std::remove(filename.c_str());
+    return EXIT_SUCCESS;
+}
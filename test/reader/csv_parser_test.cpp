@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+
+// Own
+#include <rlib/common/sample.h>
+#include <rlib/csv/csv_parser.h>
+
+// StdLib
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Whether row parses into time and values (NaN matches NaN)
+static bool check_row(const std::string& row, double time,
+    const std::vector< double >& values, char delimiter = ',')
+{
+    rlib::common::sample datum;
+    if (!rlib::csv::parse_row(
+            row.data(), row.data() + row.size(), datum, delimiter) ||
+        datum.time != time || datum.values.size() != values.size()) {
+        std::cerr << "Row \"" << row << "\" failed" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (std::isnan(values[ i ]) ? !std::isnan(datum.values[ i ])
+                                    : datum.values[ i ] != values[ i ]) {
+            std::cerr << "Row \"" << row << "\" failed" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static double parse(const std::string& field)
+{
+    return rlib::csv::parse_value(field.data(), field.data() + field.size());
+}
+
+int main(int, char* [])
+{
+    auto result = EXIT_SUCCESS;
+    const double nan = std::nan("");
+    const double inf = std::numeric_limits< double >::infinity();
+    const double denorm_min = std::numeric_limits< double >::denorm_min();
+
+    // The field scan matches a plain search for every position of the
+    // delimiter or newline before, on and after the 16 byte blocks and in
+    // tails shorter than 16 bytes
+    for (size_t size = 0; size <= 50; ++size) {
+        for (size_t pos = 0; pos <= size; ++pos) {
+            for (char stop : { ',', '\n', ';' }) {
+                // Misaligned by one to not depend on the alignment
+                std::string buffer(size + 1, 'x');
+                if (pos < size) {
+                    buffer[ pos + 1 ] = stop;
+                }
+                const char* begin = buffer.data() + 1;
+                const char* end = begin + size;
+                auto expected = std::find_if(begin, end,
+                    [](char c) { return c == ',' || c == '\n'; });
+                if (rlib::csv::find_field_end(begin, end, ',') != expected) {
+                    std::cerr << "Field scan failed (size " << size
+                              << ", pos " << pos << ")" << std::endl;
+                    result = EXIT_FAILURE;
+                }
+            }
+        }
+    }
+    // Bytes after end are not part of the field
+    {
+        std::string buffer = "0123456789abcdefghij,";
+        const char* begin = buffer.data();
+        for (size_t size : { size_t(15), size_t(16), size_t(17), size_t(20) }) {
+            if (rlib::csv::find_field_end(begin, begin + size, ',') !=
+                begin + size) {
+                result = EXIT_FAILURE;
+            }
+        }
+    }
+
+    // Lines
+    {
+        std::string text = "1,2\r\n3,4\n\n5,6";
+        const char* begin = text.data();
+        const char* end = begin + text.size();
+        const char* second = rlib::csv::next_line(begin, end);
+        const char* third = rlib::csv::next_line(second, end);
+        const char* fourth = rlib::csv::next_line(third, end);
+        if (second != begin + 5 || third != begin + 9 ||
+            fourth != begin + 10 || rlib::csv::next_line(fourth, end) != end) {
+            result = EXIT_FAILURE;
+        }
+    }
+
+    // Values
+    if (parse("1.5") != 1.5 || parse("  -2.25\t") != -2.25 ||
+        parse("+3") != 3.0 || parse("0.1") != 0.1 || parse("1e3 \r") != 1e3 ||
+        parse("5.000000000000001") != 5.000000000000001 ||
+        parse("inf") != inf || parse("-inf") != -inf ||
+        parse("1.8e308") != inf || parse("-1e400") != -inf ||
+        parse("1e-400") != 0.0 || parse("4.94e-324") != denorm_min ||
+        !std::isnan(parse("")) || !std::isnan(parse("   ")) ||
+        !std::isnan(parse("abc")) || !std::isnan(parse("1.5x")) ||
+        !std::isnan(parse("1 2")) || !std::isnan(parse("+-1")) ||
+        !std::isnan(parse("++1")) || !std::isnan(parse("nan")) ||
+        !std::isnan(parse("-nan")) || !std::isnan(parse("NaN"))) {
+        std::cerr << "Value parsing failed" << std::endl;
+        result = EXIT_FAILURE;
+    }
+
+    // Rows with CRLF, blanks, a leading plus, NaN, empty trailing fields and
+    // short rows
+    if (!check_row("1,2,3", 1.0, { 2.0, 3.0 }) ||
+        !check_row("1,2,3\r", 1.0, { 2.0, 3.0 }) ||
+        !check_row(" 1 , 2\t,\t3 \r", 1.0, { 2.0, 3.0 }) ||
+        !check_row("+1,+2,-3", 1.0, { 2.0, -3.0 }) ||
+        !check_row("1,nan,-nan", 1.0, { nan, nan }) ||
+        !check_row("1,2,", 1.0, { 2.0, nan }) ||
+        !check_row("1,,", 1.0, { nan, nan }) ||
+        !check_row("1,2,\r", 1.0, { 2.0, nan }) ||
+        !check_row("1", 1.0, {}) || !check_row("1\r", 1.0, {}) ||
+        !check_row("1;2;3", 1.0, { 2.0, 3.0 }, ';') ||
+        !check_row("0.000001,1234567890.0987654321,-1e-300", 0.000001,
+            { 1234567890.0987654321, -1e-300 })) {
+        result = EXIT_FAILURE;
+    }
+
+    // Rows without a valid time
+    rlib::common::sample datum;
+    for (std::string row : { "", "\r", " ", "nan,1", "time,a,b", ",1,2" }) {
+        if (rlib::csv::parse_row(row.data(), row.data() + row.size(), datum)) {
+            std::cerr << "Row \"" << row << "\" has no time" << std::endl;
+            result = EXIT_FAILURE;
+        }
+    }
+    return result;
+}
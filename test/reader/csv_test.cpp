@@ -38,6 +38,22 @@ int main(int, char* [])
     auto filename2 = std::tmpnam(nullptr);
     test_export_helper< rlib::csv::csv_exporter >(
         syn_reader, filename1, filename2);
-    return test_reader_helper< rlib::csv::csv_reader >(
-        syn_reader, filename1, filename2);
+    if (test_reader_helper< rlib::csv::csv_reader >(
+            syn_reader, filename1, filename2) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    // Readers may be destroyed while their rows are still loaded
+    for (int i = 0; i < 16; ++i) {
+        rlib::csv::csv_reader reader(filename1);
+        rlib::csv::csv_reader index_reader(
+            filename1, rlib::csv::csv_storage::INDEX);
+    }
+    // A missing csv is an empty reader
+    rlib::csv::csv_reader missing(std::tmpnam(nullptr));
+    if (!missing.sensors().empty() || !missing.samples(0.0, -1.0).empty() ||
+        missing.progress() != 1.0) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
 }
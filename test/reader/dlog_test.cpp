@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+
+// Own
+#include <rlib/keysight/dlog.h>
+
+// StdLib
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+static const std::string CHANNEL =
+    "<channel id=\"1\"><sense_volt>1</sense_volt><sense_curr>0</sense_curr>"
+    "<ident><option><1ua>0</1ua><2ua>0</2ua></option></ident></channel>\n"
+    "<channel id=\"2\"><sense_volt>1</sense_volt><sense_curr>1</sense_curr>"
+    "<ident><option><1ua>1</1ua><2ua>1</2ua></option></ident></channel>\n";
+static const std::string FRAME = "<frame><tint>0.001</tint></frame>\n";
+
+// Writes a dlog whose header is padded with a comment, so its </dlog> ends
+// close_at bytes into the file. Returns the size of the header.
+static size_t write_dlog(const std::string& filename, size_t close_at,
+    const std::string& line_end = "\n")
+{
+    std::string header = "<dlog>\n" + CHANNEL + FRAME + "<!-- ";
+    const std::string end = " -->\n</dlog>";
+    header.append(close_at - header.size() - end.size(), 'x');
+    header += end + line_end;
+    std::ofstream out(filename, std::ios::binary);
+    out << header;
+    // Payload (may contain a newline or a '<')
+    out << std::string("\n<\0\0\0\0\0\0", 8);
+    return header.size();
+}
+
+static bool check_header(const std::string& filename, size_t header_size)
+{
+    rlib::keysight::dlog dlog(filename);
+    return dlog.data_begin_pos == header_size && dlog.channels.size() == 2 &&
+           dlog.channels[ 0 ].id == 1 && dlog.channels[ 0 ].senseVolt &&
+           !dlog.channels[ 0 ].senseCurr && dlog.channels[ 1 ].id == 2 &&
+           dlog.channels[ 1 ].senseCurr && dlog.sampling_interval == 0.001;
+}
+
+int main(int, char* [])
+{
+    std::string filename = std::tmpnam(nullptr);
+    // The header is read in chunks of 4 KiB: </dlog> within the first
+    // chunk, split across the chunks, and its line end in the next chunk.
+    // The <1ua>/<2ua> tags are no valid xml and need the hotfix.
+    for (size_t close_at : { size_t(1000), size_t(4094), size_t(4096),
+             size_t(4099), size_t(8200) }) {
+        if (!check_header(filename, write_dlog(filename, close_at))) {
+            std::remove(filename.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    if (!check_header(filename, write_dlog(filename, 4096, "\r\n"))) {
+        std::remove(filename.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Without </dlog> the file is rejected
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << "<dlog>\n" << CHANNEL << FRAME << std::string(5000, ' ');
+    }
+    bool rejected = false;
+    try {
+        rlib::keysight::dlog dlog(filename);
+    }
+    catch (std::runtime_error& e) {
+        rejected = std::string(e.what()).find("Missing </dlog>") !=
+                   std::string::npos;
+    }
+    std::remove(filename.c_str());
+    return rejected ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+
+// Own
+#include <rlib/common/reader.h>
+#include <rlib/csv/csv_reader.h>
+#include <rlib/xml/xml_reader.h>
+
+// StdLib
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+
+// Value of sensor 0 in row i of the written files
+static double row_value(size_t i)
+{
+    return double(i % 10);
+}
+
+// Writes a csv with one sensor and the rows 0 till rows - 1 (the time of a
+// row is its number)
+static void write_csv(std::string filename, size_t rows)
+{
+    std::ofstream output(filename, std::ios::binary);
+    output << "Time,S0 (A)\n";
+    for (size_t i = 0; i < rows; ++i) {
+        output << i << ',' << row_value(i) << '\n';
+    }
+}
+
+// Writes an xml with the same rows as write_csv
+static void write_xml(std::string filename, size_t rows)
+{
+    std::ofstream output(filename, std::ios::binary);
+    output << "<output><sensors>"
+           << "<sensor id=\"0\" name=\"S0\" unit=\"A\"/>"
+           << "</sensors><dataset>\n";
+    for (size_t i = 0; i < rows; ++i) {
+        output << "<data time=\"" << i << "\"><value sensor=\"0\" value=\""
+               << row_value(i) << "\"/></data>\n";
+    }
+    output << "</dataset></output>\n";
+}
+
+// Whether the rows [first, last] are returned by the reader
+static bool check_rows(rlib::common::reader& reader, size_t first, size_t last)
+{
+    auto data = reader.samples(double(first), double(last));
+    if (data.size() != last - first + 1) {
+        return false;
+    }
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (data[ i ].time != double(first + i) ||
+            data[ i ].values.size() != 1 ||
+            data[ i ].values[ 0 ] != row_value(first + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Polls the reader while it loads. Progress and loaded time have to grow and
+// the rows loaded so far have to be returned before the whole file is loaded.
+static bool check_loading(rlib::common::reader& reader, size_t rows)
+{
+    double last_progress = 0.0;
+    double last_until = 0.0;
+    bool early = false;
+    for (;;) {
+        const double progress = reader.progress();
+        const double until = reader.loaded_until();
+        if (progress < last_progress || progress > 1.0 ||
+            until < last_until) {
+            return false;
+        }
+        last_progress = progress;
+        last_until = until;
+        if (progress == 1.0) {
+            break;
+        }
+        if (until >= 1.0) {
+            const size_t last = size_t(until) - 1;
+            const size_t first = last > 1000 ? last - 1000 : 0;
+            if (!check_rows(reader, first, last)) {
+                return false;
+            }
+            early = early || reader.progress() < 1.0;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return early && reader.loaded_until() == double(rows - 1) &&
+           reader.length() == double(rows - 1) &&
+           check_rows(reader, 0, rows - 1);
+}
+
+int main(int, char* [])
+{
+    // Both files span several batches (csv) or publications (xml) of 4 MiB
+    const size_t rows = 3000000;
+    std::string filename = std::string(std::tmpnam(nullptr)) + ".csv";
+    write_csv(filename, rows);
+    bool valid = false;
+    {
+        rlib::csv::csv_reader reader(filename);
+        valid = check_loading(reader, rows);
+    }
+    std::remove(filename.c_str());
+    if (!valid) {
+        return EXIT_FAILURE;
+    }
+
+    filename = std::string(std::tmpnam(nullptr)) + ".xml";
+    write_xml(filename, rows / 4);
+    {
+        rlib::xml::xml_reader reader(filename);
+        valid = check_loading(reader, rows / 4);
+    }
+    std::remove(filename.c_str());
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+
+// Own
+#include "util/test_helper.h"
+#include <rlib/android/meta.h>
+#include <rlib/android/meta_exporter.h>
+#include <rlib/android/meta_reader.h>
+
+// StdLib
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+int main(int, char* [])
+{
+    // Sensors fitting u8, i16, f32 and f64
+    std::vector< std::function< double(double) > > sensors = {
+        [](double t) { return std::round(t * 10); },
+        [](double t) { return std::round(t * 10) * -300; },
+        [](double t) { return 1.5; }, [](double t) { return t; }
+    };
+    // Events of the default synthetic reader
+    auto events = [](double begin, double end) {
+        return gen_syn_reader()->events(begin, end);
+    };
+    auto syn_reader = std::make_shared< rlib::common::synthetic_reader >(
+        [](double t) { return t + 0.2; }, events, sensors);
+    std::string filename = std::string(std::tmpnam(nullptr)) + ".meta";
+    {
+        rlib::android::meta_exporter exporter(syn_reader, filename);
+        std::ofstream output(filename, std::ios::binary);
+        exporter.data_export(0.0, -1, output);
+    }
+
+    rlib::android::meta meta(filename);
+    if (meta.type[ "SynthSens[0]" ] != "u8" ||
+        meta.type[ "SynthSens[1]" ] != "i16" ||
+        meta.type[ "SynthSens[2]" ] != "f32" ||
+        meta.type[ "SynthSens[3]" ] != "f64") {
+        return EXIT_FAILURE;
+    }
+
+    // Values are exact, times are stored in ns
+    rlib::android::meta_reader reader(filename);
+    auto src_data = syn_reader->samples(0.0, -1.0);
+    auto data = reader.samples(0.0, -1.0);
+    if (data.size() != src_data.size()) {
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (std::fabs(data[ i ].time - src_data[ i ].time) > 1e-9 ||
+            data[ i ].values != src_data[ i ].values) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The length is the time of the last record
+    if (data.empty() || reader.length() != data.back().time) {
+        return EXIT_FAILURE;
+    }
+
+    // Ranges are inclusive, begin and end may fall between records
+    auto check_range = [](rlib::android::meta_reader& range_reader,
+                           const std::vector< rlib::common::sample >& all,
+                           double begin, double end) {
+        std::vector< rlib::common::sample > expected;
+        for (auto& datum : all) {
+            if (begin <= datum.time && datum.time <= end) {
+                expected.push_back(datum);
+            }
+        }
+        auto range = range_reader.samples(begin, end);
+        if (range.size() != expected.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < range.size(); ++i) {
+            if (range[ i ].time != expected[ i ].time ||
+                range[ i ].values != expected[ i ].values) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!check_range(reader, data, data[ 3 ].time + 0.1, data[ 7 ].time) ||
+        !check_range(reader, data, data[ 3 ].time, data[ 7 ].time - 0.1) ||
+        !check_range(reader, data, data[ 5 ].time, data[ 5 ].time) ||
+        !check_range(
+            reader, data, data[ 5 ].time + 0.01, data[ 5 ].time + 0.1)) {
+        return EXIT_FAILURE;
+    }
+
+    // A recording which starts later, ranges may begin before its first
+    // record
+    std::string late_filename = std::string(std::tmpnam(nullptr)) + ".meta";
+    {
+        rlib::android::meta_exporter exporter(syn_reader, late_filename);
+        std::ofstream output(late_filename, std::ios::binary);
+        exporter.data_export(1.3, -1, output);
+    }
+    rlib::android::meta_reader late_reader(late_filename);
+    auto late_data = late_reader.samples(0.0, -1.0);
+    if (late_data.empty() || late_data.front().time < 1.3 - 1e-9 ||
+        late_reader.length() != late_data.back().time ||
+        !check_range(late_reader, late_data, 0.5, 2.0) ||
+        !check_range(late_reader, late_data, 0.0, 1.0) ||
+        late_reader.samples(0.5, 2.0).front().time !=
+            late_data.front().time) {
+        return EXIT_FAILURE;
+    }
+
+    auto data_events = reader.events(0.0, -1.0);
+    if (data_events.size() != 4 ||
+        std::fabs(data_events[ 0 ].time - 3.0) > 1e-9 ||
+        std::fabs(data_events[ 3 ].time - 9.0) > 1e-9) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+
+// Own
+#include "util/psi_fixture.h"
+#include <rlib/powerscale/psi_reader.h>
+
+// StdLib
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Whether events are the expected (sample, origin, raw value) entries
+static bool check_events(
+    const std::vector< rlib::common::event_data >& events, double interval,
+    const std::vector< std::tuple< uint64_t, int64_t, uint16_t > >& expected)
+{
+    if (events.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < events.size(); ++i) {
+        uint16_t raw = std::get< 2 >(expected[ i ]);
+        if (std::fabs(events[ i ].time -
+                      double(std::get< 0 >(expected[ i ])) * interval) >
+                1e-9 ||
+            events[ i ].origin != std::get< 1 >(expected[ i ]) ||
+            events[ i ].raw_data.size() != 2 ||
+            uint8_t(events[ i ].raw_data[ 0 ]) != (raw & 0xff) ||
+            uint8_t(events[ i ].raw_data[ 1 ]) != (raw >> 8)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int, char* [])
+{
+    // Four data streams, so the event words of a record are one block of
+    // four words (tested with OCCUR_MASK) and the global event word
+    std::string filename = std::string(std::tmpnam(nullptr)) + ".psi";
+    {
+        psd_fixture events;
+        {
+            events.first_sample = 0;
+            events.records = 100;
+            events.event_count = 6;
+            events.event_words[ 10 ] = { 0x0081, 0, 0, 0, 0 };
+            events.event_words[ 20 ] = { 0, 0, 0, 0x0080, 0 };
+            events.event_words[ 30 ] = { 0, 0, 0, 0, 0x0180 };
+            // Bits besides the occur bit are no events
+            events.event_words[ 40 ] = { 0x7f7f, 0xff00, 0x8000, 0x0100,
+                0x7f00 };
+            events.event_words[ 50 ] = { 0x0080, 0, 0x0082, 0, 0x0080 };
+        }
+        // The occur bits of psds without events are not scanned
+        psd_fixture no_events;
+        {
+            no_events.first_sample = 100;
+            no_events.records = 50;
+            no_events.event_count = 0;
+            no_events.event_words[ 5 ] = { 0x0080, 0x0080, 0, 0, 0x0080 };
+        }
+        write_psi_fixture(filename, 4, "1", { events, no_events });
+    }
+    rlib::powerscale::psi_reader reader(filename);
+    double interval = reader.sensors().front().sampling_interval;
+
+    if (!check_events(reader.events(0.0, -1.0), interval,
+            { std::make_tuple(10, 0, 0x0081), std::make_tuple(20, 6, 0x0080),
+                std::make_tuple(30, -1, 0x0180),
+                std::make_tuple(50, 0, 0x0080),
+                std::make_tuple(50, 4, 0x0082),
+                std::make_tuple(50, -1, 0x0080) })) {
+        return EXIT_FAILURE;
+    }
+
+    // Ranges include an event at begin and exclude an event at end
+    if (!check_events(reader.events(20 * interval, 50 * interval), interval,
+            { std::make_tuple(20, 6, 0x0080),
+                std::make_tuple(30, -1, 0x0180) }) ||
+        !check_events(reader.events(50 * interval, 51 * interval), interval,
+            { std::make_tuple(50, 0, 0x0080),
+                std::make_tuple(50, 4, 0x0082),
+                std::make_tuple(50, -1, 0x0080) }) ||
+        !check_events(
+            reader.events(11 * interval, 20 * interval), interval, {}) ||
+        !check_events(
+            reader.events(51 * interval, 150 * interval), interval, {})) {
+        return EXIT_FAILURE;
+    }
+
+    // A recording without any events
+    std::string quiet_filename = std::string(std::tmpnam(nullptr)) + ".psi";
+    {
+        psd_fixture quiet;
+        {
+            quiet.first_sample = 0;
+            quiet.records = 10;
+            quiet.event_count = 0;
+        }
+        write_psi_fixture(quiet_filename, 1, "1", { quiet });
+    }
+    rlib::powerscale::psi_reader quiet_reader(quiet_filename);
+    if (!quiet_reader.events(0.0, -1.0).empty() ||
+        quiet_reader.samples(0.0, -1.0).size() != 10) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+
+// Own
+#include "util/psi_fixture.h"
+#include <rlib/powerscale/psi_reader.h>
+
+// StdLib
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Whether data are the count samples of the fixture from first_sample on
+static bool check_samples(const std::vector< rlib::common::sample >& data,
+    double interval, uint64_t first_sample, size_t count)
+{
+    if (data.size() != count) {
+        return false;
+    }
+    for (size_t i = 0; i < data.size(); ++i) {
+        uint64_t sample = first_sample + i;
+        if (std::fabs(data[ i ].time - double(sample) * interval) > 1e-9 ||
+            data[ i ].values.size() != 2 ||
+            data[ i ].values[ 0 ] != psi_fixture_value(sample, 0) ||
+            data[ i ].values[ 1 ] != psi_fixture_value(sample, 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int, char* [])
+{
+    // Two psds, each larger than a parallel slice of psi_reader, with an
+    // event in both
+    std::string filename = std::string(std::tmpnam(nullptr)) + ".psi";
+    {
+        psd_fixture first;
+        {
+            first.first_sample = 0;
+            first.records = 20000;
+            first.event_count = 1;
+            first.event_words[ 19999 ] = { 0x0080, 0 };
+        }
+        psd_fixture second;
+        {
+            second.first_sample = 20000;
+            second.records = 25000;
+            second.event_count = 1;
+            second.event_words[ 0 ] = { 0, 0x0080 };
+        }
+        write_psi_fixture(filename, 1, "1", { first, second });
+    }
+    rlib::powerscale::psi_reader reader(filename);
+    double interval = reader.sensors().front().sampling_interval;
+
+    // Bounds between samples avoid depending on the rounding of the bounds
+    if (!check_samples(reader.samples(0.0, -1.0), interval, 0, 45000) ||
+        !check_samples(reader.samples(19990.5 * interval,
+                           20010.5 * interval),
+            interval, 19990, 20) ||
+        !check_samples(reader.samples(5000.5 * interval, 40000.5 * interval),
+            interval, 5000, 35000) ||
+        !check_samples(reader.samples(20000.5 * interval, -1.0), interval,
+            20000, 25000) ||
+        !check_samples(reader.samples(100.5 * interval, 200.5 * interval),
+            interval, 100, 100)) {
+        return EXIT_FAILURE;
+    }
+
+    // A range ending with the first psd prefetches the second one (20 s is
+    // exactly the end of the first psd at 1 kHz)
+    if (!check_samples(reader.samples(15000.5 * interval, 20.0), interval,
+            15000, 5000) ||
+        !check_samples(reader.samples(19999.5 * interval, 20000.5 * interval),
+            interval, 19999, 1)) {
+        return EXIT_FAILURE;
+    }
+
+    // Events of both psds, split at the border
+    auto events = reader.events(19998.5 * interval, 20001.5 * interval);
+    if (events.size() != 2 || events[ 0 ].origin != 0 ||
+        events[ 1 ].origin != -1 ||
+        std::fabs(events[ 0 ].time - 19999 * interval) > 1e-9 ||
+        std::fabs(events[ 1 ].time - 20000 * interval) > 1e-9) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
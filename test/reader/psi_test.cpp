@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+// Ext
+
+// Own
+#include "util/test_helper.h"
+#include <rlib/powerscale/psi_exporter.h>
+#include <rlib/powerscale/psi_reader.h>
+
+// StdLib
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Exports src as psi and compares the samples read back with the source
+static bool round_trip(
+    std::shared_ptr< rlib::common::reader > src, const std::string& filename)
+{
+    {
+        rlib::powerscale::psi_exporter exporter(src, filename);
+        std::ofstream output(filename, std::ios::binary);
+        exporter.data_export(0.0, -1, output);
+    }
+    rlib::powerscale::psi_reader reader(filename);
+    auto src_data = src->samples(0.0, -1.0);
+    auto data = reader.samples(0.0, -1.0);
+    if (data.size() != src_data.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (std::fabs(data[ i ].time - src_data[ i ].time) > 1e-9) {
+            return false;
+        }
+        for (size_t j = 0; j < src_data[ i ].values.size(); ++j) {
+            if (data[ i ].values[ j ] != src_data[ i ].values[ j ]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int, char* [])
+{
+    auto syn_reader = gen_syn_reader();
+    std::string filename = std::string(std::tmpnam(nullptr)) + ".psi";
+    {
+        rlib::powerscale::psi_exporter exporter(syn_reader, filename);
+        std::ofstream output(filename, std::ios::binary);
+        exporter.data_export(0.0, -1, output);
+    }
+    rlib::powerscale::psi_reader reader(filename);
+
+    // The three sensors are stored as two data streams (the last voltage is
+    // missing), times are multiples of the sampling interval
+    auto src_data = syn_reader->samples(0.0, -1.0);
+    auto data = reader.samples(0.0, -1.0);
+    if (reader.sensors().size() != 4 || data.size() != src_data.size()) {
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (std::fabs(data[ i ].time - src_data[ i ].time) > 1e-9) {
+            return EXIT_FAILURE;
+        }
+        for (size_t j = 0; j < src_data[ i ].values.size(); ++j) {
+            if (data[ i ].values[ j ] != src_data[ i ].values[ j ]) {
+                return EXIT_FAILURE;
+            }
+        }
+        if (!std::isnan(data[ i ].values[ 3 ])) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Events keep the sensor of their origin, the events of the current and
+    // the voltage at 9.0 are in the first data stream and share one event
+    auto events = reader.events(0.0, -1.0);
+    if (events.size() != 3) {
+        return EXIT_FAILURE;
+    }
+    if (std::fabs(events[ 0 ].time - 3.0) > 1e-9 || events[ 0 ].origin != -1 ||
+        std::fabs(events[ 1 ].time - 4.0) > 1e-9 || events[ 1 ].origin != 2 ||
+        std::fabs(events[ 2 ].time - 9.0) > 1e-9 || events[ 2 ].origin != 0) {
+        return EXIT_FAILURE;
+    }
+
+    // A rate which is not a whole number of Hz (0.3 s interval), events on
+    // samples keep their time
+    auto rate_events = [](double begin, double end) {
+        std::vector< rlib::common::event_data > events;
+        for (double time : { 3.0, 6.0 }) {
+            if (begin <= time && (end < 0 || time <= end)) {
+                rlib::common::event_data event;
+                {
+                    event.time = time;
+                    event.origin = time < 4.0 ? -1 : 0;
+                    event.raw_data = { 0x01, 0x02 };
+                }
+                events.push_back(event);
+            }
+        }
+        return events;
+    };
+    std::vector< std::function< double(double) > > rate_sensors = {
+        [](double t) { return t * 2; }, [](double t) { return -t; }
+    };
+    auto rate_reader = std::make_shared< rlib::common::synthetic_reader >(
+        [](double t) { return t + 0.3; }, rate_events, rate_sensors);
+    std::string rate_filename = std::string(std::tmpnam(nullptr)) + ".psi";
+    if (!round_trip(rate_reader, rate_filename)) {
+        return EXIT_FAILURE;
+    }
+    rlib::powerscale::psi_reader rate_psi(rate_filename);
+    auto rate_psi_events = rate_psi.events(0.0, -1.0);
+    if (std::fabs(rate_psi.sensors()[ 0 ].sampling_interval - 0.3) > 1e-12 ||
+        rate_psi_events.size() != 2 ||
+        std::fabs(rate_psi_events[ 0 ].time - 3.0) > 1e-9 ||
+        std::fabs(rate_psi_events[ 1 ].time - 6.0) > 1e-9 ||
+        rate_psi.samples(3.0, 6.0).size() != 10) {
+        return EXIT_FAILURE;
+    }
+
+    // Gaps in the samples are kept (as psds starting after the gap)
+    auto gap_reader = std::make_shared< rlib::common::synthetic_reader >(
+        [](double t) { return std::fabs(t - 3.0) < 0.01 ? t + 1.5 : t + 0.3; },
+        rate_events, rate_sensors);
+    std::string gap_filename = std::string(std::tmpnam(nullptr)) + ".psi";
+    if (!round_trip(gap_reader, gap_filename) ||
+        rlib::powerscale::psi(gap_filename).psds().size() != 2) {
+        return EXIT_FAILURE;
+    }
+
+    // Write errors are reported
+    try {
+        rlib::powerscale::psi_exporter exporter(rate_reader, rate_filename);
+        std::ofstream closed;
+        exporter.data_export(0.0, -1, closed);
+        return EXIT_FAILURE;
+    }
+    catch (std::runtime_error&) {
+    }
+    return EXIT_SUCCESS;
+}
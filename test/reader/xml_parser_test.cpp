@@ -0,0 +1,186 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+// Ext
+
+// Own
+#include <rlib/xml/xml_parser.h>
+#include <rlib/xml/xml_reader.h>
+
+// StdLib
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using node = rlib::xml::xml_pull_parser::node;
+
+// Nodes of document, START and END as "<name" and "</name", TEXT as its
+// decoded text
+static std::vector< std::string > nodes(const std::string& document)
+{
+    rlib::xml::xml_pull_parser parser(
+        document.data(), document.data() + document.size());
+    std::vector< std::string > result;
+    for (auto n = parser.next(); n != node::DONE; n = parser.next()) {
+        if (n == node::START) {
+            result.push_back("<" + std::string(parser.name()));
+        }
+        else if (n == node::END) {
+            result.push_back("</" + std::string(parser.name()));
+        }
+        else {
+            result.push_back(parser.text());
+        }
+    }
+    return result;
+}
+
+// Whether parsing document throws a runtime_error
+static bool throws(const std::string& document)
+{
+    try {
+        nodes(document);
+    }
+    catch (std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+int main(int, char* [])
+{
+    auto result = EXIT_SUCCESS;
+    auto check = [&result](bool ok, const char* what) {
+        if (!ok) {
+            std::cerr << what << " failed" << std::endl;
+            result = EXIT_FAILURE;
+        }
+    };
+
+    // Comments, processing instructions and declarations are skipped, CDATA
+    // is kept raw
+    check(nodes("<?xml version=\"1.0\"?><!DOCTYPE a><!-- <b> -- -->"
+                "<a><!--x-->t<?pi <c>?><![CDATA[<&amp;>]]></a>") ==
+              std::vector< std::string >(
+                  { "<a", "t", "<&amp;>", "</a" }),
+        "Comments, instructions and CDATA");
+
+    // Self-closing tags are a start and an end, quoted '>' and '/' belong
+    // to attributes
+    {
+        std::string document =
+            "<a x='1>2' y=\"/>\" z = \"3\"/><b/><c ></c>";
+        rlib::xml::xml_pull_parser parser(
+            document.data(), document.data() + document.size());
+        std::string_view value;
+        check(parser.next() == node::START && parser.name() == "a" &&
+                  parser.attribute("x", value) && value == "1>2" &&
+                  parser.attribute("y", value) && value == "/>" &&
+                  parser.attribute("z", value) && value == "3" &&
+                  !parser.attribute("w", value),
+            "Quoted attributes");
+        check(parser.next() == node::END && parser.name() == "a" &&
+                  parser.next() == node::START && parser.name() == "b" &&
+                  parser.next() == node::END && parser.name() == "b" &&
+                  parser.next() == node::START && parser.name() == "c" &&
+                  parser.next() == node::END && parser.name() == "c" &&
+                  parser.next() == node::DONE,
+            "Self-closing tags");
+    }
+
+    // Predefined and numeric references, invalid ones are kept
+    check(rlib::xml::decode_entities("&lt;&gt;&amp;&quot;&apos;") ==
+              "<>&\"'",
+        "Predefined references");
+    check(rlib::xml::decode_entities("&#65;&#x42;&#X43;&#xe9;&#x20AC;") ==
+              "ABC\xC3\xA9\xE2\x82\xAC",
+        "Numeric references");
+    check(rlib::xml::decode_entities("&#x1F600;") == "\xF0\x9F\x98\x80",
+        "Supplementary references");
+    for (std::string invalid : { "&foo;", "&#;", "&#x;", "&#12a;", "&#0;",
+             "&#xD800;", "&#x110000;", "&#99999999999;", "&amp", "a & b" }) {
+        check(rlib::xml::decode_entities(invalid) == invalid,
+            "Invalid references");
+    }
+    check(nodes("<a>&lt;x&gt; &amp;amp;</a>")[ 1 ] == "<x> &amp;",
+        "Decoded text");
+
+    // Numbers
+    check(rlib::xml::parse_double(" 1.5 ", 0.0) == 1.5 &&
+              rlib::xml::parse_double("x", -1.0) == -1.0 &&
+              rlib::xml::parse_int("42", 0) == 42 &&
+              rlib::xml::parse_int("4x", -1) == -1,
+        "Numbers");
+
+    // Unterminated constructs
+    check(throws("<a><!-- x</a>") && throws("<a><![CDATA[x</a>") &&
+              throws("<?pi") && throws("<!DOCTYPE") && throws("<a x='>'"),
+        "Unterminated constructs");
+
+    // The reader rejects mismatched end tags and gives sensors sharing an
+    // id the same values (like the tree based reader did)
+    std::string filename = std::string(std::tmpnam(nullptr)) + ".xml";
+    {
+        std::ofstream output(filename, std::ios::binary);
+        output << "<output><sensors>"
+               << "<sensor id=\"1\" name=\"A &amp; B\" unit=\"V\"/>"
+               << "<sensor id=\"1\" name=\"Copy\" unit=\"V\"/>"
+               << "<sensor id=\"2\" name=\"C\" unit=\"A\"/>"
+               << "</sensors><dataset>"
+               << "<data time=\"0.5\"><value sensor=\"1\" value=\"3\"/>"
+               << "<value sensor=\"2\" value=\"4\"/></data>"
+               << "<data time=\"1\"><value sensor=\"1\" value=\"5\"/></data>"
+               << "</dataset></output>";
+    }
+    {
+        rlib::xml::xml_reader reader(filename);
+        auto sensors = reader.sensors();
+        auto data = reader.samples(0.0, -1.0);
+        check(sensors.size() == 3 && sensors[ 0 ].name == "A & B" &&
+                  data.size() == 2 && data[ 0 ].values[ 0 ] == 3.0 &&
+                  data[ 0 ].values[ 1 ] == 3.0 &&
+                  data[ 0 ].values[ 2 ] == 4.0 &&
+                  data[ 1 ].values[ 1 ] == 5.0 &&
+                  std::isnan(data[ 1 ].values[ 2 ]),
+            "Duplicate sensor ids");
+    }
+    {
+        std::ofstream output(filename, std::ios::binary);
+        output << "<output><sensors></output></sensors>";
+    }
+    try {
+        // The document is loaded asynchronously, errors surface on access
+        rlib::xml::xml_reader reader(filename);
+        reader.samples(0.0, -1.0);
+        check(false, "Mismatched end tag");
+    }
+    catch (std::runtime_error&) {
+    }
+    std::remove(filename.c_str());
+    return result;
+}
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2016-2017, Daniel "Dadie" Korner
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Neither the source code nor the binary may be used for any military use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY Daniel "Dadie" Korner ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL Daniel "Dadie" Korner BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **/
+#pragma once
+
+// Ext
+
+// Own
+
+// StdLib
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Psd of a hand written psi fixture
+class psd_fixture {
+    public:
+    uint64_t first_sample;
+    size_t records;
+    // EventCount declared in the psi
+    uint64_t event_count;
+    // Event words (every data stream followed by the global event) of the
+    // records (within the psd) with events
+    std::map< size_t, std::vector< uint16_t > > event_words;
+};
+
+// Value of column (current and voltage of every data stream) of sample
+inline double psi_fixture_value(uint64_t sample, size_t column)
+{
+    return double(sample) + double(column) / 8.0;
+}
+
+// Writes the psi filename (ending with .psi) with data_streams data streams
+// sampled at sampling_rate (in kHz, as written into the psi) and its psds
+// next to it
+inline void write_psi_fixture(const std::string& filename,
+    size_t data_streams, const std::string& sampling_rate,
+    const std::vector< psd_fixture >& psds)
+{
+    const size_t values_per_interval = data_streams * 2;
+    const size_t record_size = values_per_interval * sizeof(double) +
+                               (data_streams + 1) * sizeof(uint16_t);
+    const std::string base = filename.substr(0, filename.size() - 4);
+    uint64_t samples = 0;
+    for (size_t id = 0; id < psds.size(); ++id) {
+        const auto& psd = psds[ id ];
+        std::vector< char > data(psd.records * record_size, 0);
+        for (size_t record = 0; record < psd.records; ++record) {
+            char* pos = data.data() + record * record_size;
+            for (size_t column = 0; column < values_per_interval; ++column) {
+                double value =
+                    psi_fixture_value(psd.first_sample + record, column);
+                std::memcpy(
+                    pos + column * sizeof(double), &value, sizeof(value));
+            }
+            auto words = psd.event_words.find(record);
+            if (words != psd.event_words.end()) {
+                std::memcpy(pos + values_per_interval * sizeof(double),
+                    words->second.data(),
+                    words->second.size() * sizeof(uint16_t));
+            }
+        }
+        std::ofstream psd_stream(
+            base + "_" + std::to_string(id) + ".psd", std::ios::binary);
+        psd_stream.write(data.data(), std::streamsize(data.size()));
+        samples = std::max(samples, psd.first_sample + psd.records);
+    }
+
+    std::ofstream psi_stream(filename, std::ios::binary);
+    psi_stream << "<PSI>\n<Checksum Value=\"0x0\"/>\n<Measurement>\n"
+               << "<SamplingRate Value=\"" << sampling_rate << "\"/>\n"
+               << "<SamplingCount Value=\"" << samples * values_per_interval
+               << "\"/>\n</Measurement>\n<DataStream>\n";
+    for (size_t i = 0; i < data_streams; ++i) {
+        psi_stream << "<DataStream Id=\"" << i << "\" ProbeID=\"" << i
+                   << "\" ProbeKind=\"0\"/>\n";
+    }
+    psi_stream << "</DataStream>\n<PSD>\n";
+    for (size_t id = 0; id < psds.size(); ++id) {
+        psi_stream << "<PSDFile Id=\"" << id << "\" Offset=\""
+                   << psds[ id ].first_sample * values_per_interval
+                   << "\" DataCount=\""
+                   << psds[ id ].records * values_per_interval
+                   << "\" EventCount=\"" << psds[ id ].event_count << "\"/>\n";
+    }
+    psi_stream << "</PSD>\n</PSI>\n";
+}